@@ -12,6 +12,8 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import os
+
 from setuptools import setup, Extension
 from setuptools.command.build_ext import build_ext
 from Cython.Build import cythonize
@@ -23,12 +25,12 @@ class build_ext_with_args(build_ext):
 
     extra_compile_args = {
         'msvc': ['/std:c++14'],
-        'unix': ['-std=c++11'],
+        'unix': ['-std=c++11', '-pthread'],
     }
 
     extra_link_args = {
         'msvc': [],
-        'unix': ['-std=c++11'],
+        'unix': ['-std=c++11', '-pthread'],
     }
 
     def build_extensions(self):
@@ -40,15 +42,20 @@ class build_ext_with_args(build_ext):
 
         link_args = self.extra_link_args[compiler]
         for ext in self.extensions:
-            ext.extra_compile_args = link_args
+            ext.extra_link_args = link_args
 
         super().build_extensions()
 
 
 extensions = [Extension(
     name='tabu.tabu_search',
-    sources=['tabu/tabu_search.pyx', 'tabu/src/utils.cpp', 'tabu/src/bqp.cpp'],
-    include_dirs=[numpy.get_include()]
+    sources=['tabu/tabu_search.pyx', 'tabu/src/utils.cpp', 'tabu/src/bqp.cpp',
+             'tabu/src/elite_pool.cpp', 'tabu/src/problem_file.cpp', 'tabu/src/kernels.cpp',
+             'tabu/src/move_tree.cpp', 'tabu/src/selection_weights.cpp',
+             'tabu/src/zobrist.cpp'],
+    include_dirs=[numpy.get_include()],
+    # Set TABU_PHASE_TIMING in the environment to record the time per phase of the search
+    define_macros=[('TABU_PHASE_TIMING', None)] if os.environ.get('TABU_PHASE_TIMING') else [],
 )]
 
 setup(
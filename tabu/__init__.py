@@ -15,7 +15,7 @@
 __package_name__ = 'dwave-tabu'
 __version__ = '0.4.5'
 
-__all__ = ['TabuSearch', 'TabuSampler']
+__all__ = ['TabuSearch', 'TabuSampler', 'Cancellation']
 
-from tabu.tabu_search import TabuSearch
+from tabu.tabu_search import TabuSearch, Cancellation
 from tabu.sampler import TabuSampler
@@ -14,10 +14,16 @@
 
 """A dimod :term:`sampler` that uses the MST2 multistart tabu search algorithm."""
 
+import hashlib
+import threading
+import time
+from collections import OrderedDict
+
 import numpy as np
 import dimod
 
-from tabu import TabuSearch
+from tabu.problem_file import problem_from_vectors, read_problem_file
+from tabu.tabu_search import tabu_search_batch, tabu_search_many, Cancellation, PHASE_TIMING
 
 __all__ = ["TabuSampler"]
 
@@ -40,6 +46,16 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
     properties = None
     parameters = None
 
+    problem_cache_size = 8
+    """Number of prepared problems a sampler keeps for later calls of :meth:`sample`.
+
+    Sampling a cached BQM again skips building the search's form of it, but
+    still converts the BQM to vectors and hashes them, as dimod BQMs can be
+    changed in place without any cheaper sign of it. The hash alone takes
+    about a third of the time of building the problem, some 50 ms per
+    million couplings.
+    """
+
     def __init__(self):
         self.parameters = {
             'initial_states': [],
@@ -50,12 +66,31 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
             'timeout': [],
             'num_restarts': [],
             'energy_threshold': [],
+            'num_threads': [],
+            'num_workers': [],
+            'max_evaluations': [],
+            'progress_callback': [],
+            'progress_interval': [],
+            'cancellation': [],
+            'total_timeout': [],
+            'stop_all_on_threshold': [],
+            'elite_size': [],
+            'path_relinking': [],
+            'visited_minima': [],
+            'max_revisits': [],
         }
         self.properties = {}
 
+        # Prepared problems by content of the binary BQM, least recently used first
+        self._problems = OrderedDict()
+        self._problems_lock = threading.Lock()
+
     def sample(self, bqm, initial_states=None, initial_states_generator='random',
                num_reads=None, seed=None, tenure=None, timeout=20, num_restarts=1000000, 
-               energy_threshold=None, **kwargs):
+               energy_threshold=None, num_threads=1, num_workers=1, max_evaluations=None,
+               progress_callback=None, progress_interval=0.1, cancellation=None,
+               total_timeout=None, stop_all_on_threshold=False, elite_size=None,
+               path_relinking=False, visited_minima=None, max_revisits=None, **kwargs):
         """Run a multistart tabu search on a given binary quadratic model.
 
         Args:
@@ -93,7 +128,8 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
             seed (int (32-bit unsigned integer), optional):
                 Seed to use for the PRNG. If the `timeout` parameter is not None, 
                 results from the same seed may not be identical between runs due to 
-                finite clock resolution.
+                finite clock resolution. Set `timeout` to None and bound the run
+                with `max_evaluations` or `num_restarts` for reproducible results.
             
             tenure (int, optional):
                 Tabu tenure, which is the length of the tabu list, or number of recently
@@ -110,8 +146,99 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
             energy_threshold (float, optional):
                 Terminate when an energy lower than ``energy_threshold`` is found.
 
+            num_threads (int, optional, default=1):
+                Number of threads the reads are distributed over. Use 0 for
+                one thread per CPU core. The problem is shared by all reads.
+
+            num_workers (int, optional, default=1):
+                Number of threads cooperating on each read. Workers run the
+                restarts of a read in parallel, each restarting from the best
+                solution found by any of them, and stop together on
+                ``timeout``, ``num_restarts`` (shared by the workers) or
+                ``energy_threshold``. Results are not reproducible from
+                ``seed`` when ``num_workers`` is greater than 1. With more than
+                one worker, at most one read per ``num_workers`` CPU cores runs
+                at a time, whatever ``num_threads``.
+
+            max_evaluations (int, optional):
+                Work budget per read, as the number of moves evaluated (each
+                tabu iteration evaluates every variable). The search stops
+                once it is used up. Unlike ``timeout``, the budget does not
+                depend on the speed of the machine, so with ``timeout=None``
+                and ``num_workers=1`` results are identical from run to run
+                for a given ``seed``. With more workers, every worker gets
+                this budget. Unlimited by default.
+
+            progress_callback (callable, optional):
+                Called as ``progress_callback(progress)`` while sampling, where
+                ``progress`` is a :class:`~tabu.tabu_search.Progress` named
+                tuple with fields ``read``, ``energy`` (best energy of the read
+                so far), ``num_restarts``, ``num_iterations``,
+                ``num_evaluations`` and ``elapsed`` (seconds since the read
+                started). It is called when the best energy of a read improves,
+                rate limited by ``progress_interval``, and when the read ends.
+                Returning a true value stops all reads early; exceptions are
+                propagated the same way and then re-raised.
+
+            progress_interval (float, optional, default=0.1):
+                Minimum time between two calls of ``progress_callback`` for one
+                read, in seconds.
+
+            cancellation (:class:`~tabu.tabu_search.Cancellation`, optional):
+                Token to stop sampling from another thread: once its
+                ``cancel()`` is called, all reads stop within one tabu
+                iteration and the best samples found so far are returned.
+                Sampling from the main thread is also stopped by a
+                ``KeyboardInterrupt``, which is then re-raised.
+
+            total_timeout (int, optional):
+                Total running time of all reads in milliseconds. Reads still
+                running when it is used up stop, and reads not started by then
+                return little more than their initial state. Unlimited by
+                default; ``timeout`` still bounds every read.
+
+            stop_all_on_threshold (bool, optional, default=False):
+                If True, all reads stop as soon as one of them finds an energy
+                lower than ``energy_threshold``, instead of every read
+                searching until it finds one.
+
+            elite_size (int, optional):
+                If given, every read keeps its ``elite_size`` best solutions
+                that differ from each other in at least 1% of the variables,
+                and returns all of them instead of its best solution only.
+
+            path_relinking (bool, optional, default=False):
+                If True, every other restart of a read starts from a solution
+                on the path between two of its elite solutions, rather than
+                from a perturbation of the last solution, which steers the
+                search away from the regions it has explored. Takes an
+                ``elite_size`` of at least 2. Usually finds lower energies
+                within the same ``timeout`` on large sparse problems.
+
+            visited_minima (int, optional):
+                If given, every read remembers up to ``visited_minima`` local
+                minima it reached, by hashes of the solutions, and counts the
+                ones it reaches again.
+
+            max_revisits (int, optional):
+                If given, a tabu search that reaches more than
+                ``max_revisits`` minima it reached before, since it last
+                improved on its best solution, ends early, and the next
+                restarts perturb twice as many variables. Takes
+                ``visited_minima``.
+
         Returns:
             :class:`~dimod.SampleSet`: A `dimod` :class:`.~dimod.SampleSet` object.
+            Its data vectors hold the number of restarts, tabu iterations and
+            evaluated moves of every read, and its info the totals of these
+            and the sampling time in seconds. If the extension was built with
+            ``TABU_PHASE_TIMING`` set, info also holds ``phase_times``, the
+            time in seconds and number of calls of each phase of the search
+            summed over the reads. With ``elite_size``, it holds the elite
+            solutions of every read, best first, and a ``read`` data vector
+            gives the read of each. With ``visited_minima``, data vectors and
+            info also hold the number of local minima reached, of revisits of
+            minima and of tabu searches ended by revisits.
 
         Examples:
             This example samples a simple two-variable Ising model.
@@ -146,22 +273,75 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
 
         parsed_initial_states = np.ascontiguousarray(parsed.initial_states.record.sample)
 
-        qubo, varorder = self._bqm_to_tabu_qubo(bqm.binary)
+        problem, varorder = self._prepare(bqm.binary)
 
         if timeout is None:
             timeout = -1    # Using negative timeout to mean ignore timeout parameter
 
-        # run Tabu search
-        samples = np.empty((parsed.num_reads, len(bqm)), dtype=np.int8)
+        if not isinstance(num_threads, int) or num_threads < 0:
+            raise ValueError("'num_threads' should be a non-negative integer")
 
-        rng = np.random.default_rng(seed)
+        if not isinstance(num_workers, int) or num_workers < 1:
+            raise ValueError("'num_workers' should be a positive integer")
+
+        if max_evaluations is not None and (
+                not isinstance(max_evaluations, int) or max_evaluations < 0):
+            raise ValueError("'max_evaluations' should be a non-negative integer")
+
+        if progress_callback is not None and not callable(progress_callback):
+            raise TypeError("'progress_callback' should be callable")
+
+        if not progress_interval >= 0:
+            raise ValueError("'progress_interval' should be a non-negative number")
+
+        self._check_stopping(cancellation, total_timeout)
 
-        restarts = []
-        for ni, initial_state in enumerate(parsed_initial_states):
-            seed_per_read = rng.integers(2**32, dtype=np.uint32)
-            r = TabuSearch(qubo, initial_state, tenure, timeout, num_restarts, seed_per_read, energy_threshold)
-            samples[ni, :] = r.bestSolution()
-            restarts.append(r.numRestarts())
+        if elite_size is not None and (not isinstance(elite_size, int) or elite_size < 1):
+            raise ValueError("'elite_size' should be a positive integer")
+
+        if path_relinking and (elite_size is None or elite_size < 2):
+            raise ValueError("'path_relinking' takes an 'elite_size' of at least 2")
+
+        self._check_revisits(visited_minima, max_revisits)
+
+        # the search reports QUBO energies, offset them to energies of bqm
+        progress = None
+        if progress_callback is not None:
+            offset = bqm.binary.offset
+
+            def progress(report):
+                return progress_callback(report._replace(energy=report.energy + offset))
+
+        # run Tabu search
+        rng = np.random.default_rng(seed)
+        seeds = np.array([rng.integers(2**32, dtype=np.uint32) for _ in range(parsed.num_reads)],
+                         dtype=np.uint32)
+
+        start = time.perf_counter()
+        samples, _, restarts, iterations, evaluations, phase_times, *extra = tabu_search_batch(
+            problem, parsed_initial_states, seeds, tenure, timeout, num_restarts,
+            energy_threshold, num_workers, num_threads, max_evaluations,
+            progress, progress_interval, cancellation, total_timeout, stop_all_on_threshold,
+            elite_size or 0, path_relinking, visited_minima or 0,
+            -1 if max_revisits is None else max_revisits)
+        info = dict(num_restarts=int(restarts.sum()),
+                    num_iterations=int(iterations.sum()),
+                    num_evaluations=int(evaluations.sum()),
+                    sampling_time=time.perf_counter() - start)
+        if PHASE_TIMING:
+            info.update(phase_times=phase_times)
+
+        vectors = dict(num_restarts=restarts, num_iterations=iterations,
+                       num_evaluations=evaluations)
+        if visited_minima:
+            self._add_revisits(extra.pop(), info, vectors)
+        if elite_size:
+            # every read gives its elites, best first, and the statistics go with each
+            elites, = extra
+            read = np.repeat(np.arange(len(samples)), elites.counts)
+            samples = elites.samples[np.arange(elite_size) < elites.counts[:, np.newaxis]]
+            vectors = {name: vector[read] for name, vector in vectors.items()}
+            vectors.update(read=read)
 
         # we received samples in binary form, so convert if needed
         if bqm.vartype is dimod.SPIN:
@@ -171,18 +351,286 @@ class TabuSampler(dimod.Sampler, dimod.Initialized):
             # sanity check
             raise ValueError("unknown vartype")
 
-        return dimod.SampleSet.from_samples_bqm((samples, varorder), bqm=bqm, num_restarts=restarts)
+        return dimod.SampleSet.from_samples_bqm((samples, varorder), bqm=bqm, info=info,
+                                                **vectors)
+
+    def sample_many(self, bqms, num_reads=1, seed=None, tenure=None, timeout=20,
+                    num_restarts=1000000, energy_threshold=None, num_threads=1,
+                    max_evaluations=None):
+        """Run a multistart tabu search on each of many small binary quadratic
+        models in one call.
+
+        The models are converted to one concatenated sparse form, without
+        building a QUBO matrix for any of them, and all their reads are
+        distributed over one native thread pool. This avoids the overhead of
+        a :meth:`sample` call per model when the models are small.
+
+        Args:
+            bqms (iterable of :class:`~dimod.BinaryQuadraticModel`):
+                The binary quadratic models (BQMs) to be sampled.
+
+            num_reads (int, optional, default=1):
+                Number of reads per model, each starting from a random state.
+
+            seed (int (32-bit unsigned integer), optional):
+                Seed to use for the PRNG, as in :meth:`sample`.
+
+            tenure (int, optional):
+                Tabu tenure used for every model. Default is a quarter of the
+                number of variables of each model up to a maximum value of 20.
+
+            timeout (int, optional, default=20):
+                Total running time per read in milliseconds.
+
+            num_restarts (int, optional, default=1,000,000):
+                Number of tabu search restarts per read.
+
+            energy_threshold (float, optional):
+                Terminate a read when it finds an energy lower than
+                ``energy_threshold``, in terms of the QUBO of each model
+                without its offset.
+
+            num_threads (int, optional, default=1):
+                Number of threads the reads of all models are distributed
+                over. Use 0 for one thread per CPU core.
+
+            max_evaluations (int, optional):
+                Work budget per read, as in :meth:`sample`.
+
+        Returns:
+            list: A :class:`~dimod.SampleSet` per model, in the order given.
+
+        Examples:
+            >>> import dimod
+            >>> import tabu
+            >>> bqms = [dimod.BQM.from_ising({}, {'ab': J}) for J in (-1, 1)]
+            >>> [sampleset.first.energy for sampleset in tabu.TabuSampler().sample_many(bqms)]
+            [-1.0, -1.0]
+        """
+        bqms = list(bqms)
+
+        if not isinstance(num_reads, int) or num_reads < 1:
+            raise ValueError("'num_reads' should be a positive integer")
+
+        if tenure is None:
+            tenure = 0      # the default of each problem
+        elif not isinstance(tenure, int):
+            raise TypeError("'tenure' should be an integer in range [0, num_vars - 1]")
+        elif not all(0 <= tenure < len(bqm) for bqm in bqms if bqm):
+            raise ValueError("'tenure' should be an integer in range [0, num_vars - 1]")
+
+        if timeout is None:
+            timeout = -1
+
+        if not isinstance(num_threads, int) or num_threads < 0:
+            raise ValueError("'num_threads' should be a non-negative integer")
+
+        if max_evaluations is not None and (
+                not isinstance(max_evaluations, int) or max_evaluations < 0):
+            raise ValueError("'max_evaluations' should be a non-negative integer")
+
+        vectors = [bqm.binary.to_numpy_vectors(return_labels=True) for bqm in bqms]
+        num_vars = np.array([len(v[0]) for v in vectors], dtype=np.intc)
+        offsets = np.zeros(len(bqms) + 1, dtype=np.int64)
+        np.cumsum([len(v[1][2]) for v in vectors], out=offsets[1:])
+
+        def concatenate(arrays, dtype):
+            return np.concatenate(arrays) if arrays else np.empty(0, dtype=dtype)
+
+        linear = concatenate([v[0] for v in vectors], np.double)
+        irow = concatenate([v[1][0] for v in vectors], np.intc)
+        icol = concatenate([v[1][1] for v in vectors], np.intc)
+        values = concatenate([v[1][2] for v in vectors], np.double)
+
+        rng = np.random.default_rng(seed)
+        initial_states = rng.integers(2, size=num_reads * len(linear), dtype=np.int8)
+        seeds = rng.integers(2**32, size=num_reads * len(bqms), dtype=np.uint32)
+
+        samples, _ = tabu_search_many(num_vars, linear, offsets, irow, icol, values,
+                                      initial_states, seeds, tenure, timeout, num_restarts,
+                                      energy_threshold, num_threads, max_evaluations)
+
+        samplesets = []
+        start = 0
+        for bqm, n, (_, _, _, varorder) in zip(bqms, num_vars, vectors):
+            sample = samples[start:start + num_reads * n].reshape(num_reads, n)
+            start += num_reads * n
+
+            # we received samples in binary form, so convert if needed
+            if bqm.vartype is dimod.SPIN:
+                sample = 2 * sample - 1
+            elif bqm.vartype is not dimod.BINARY:
+                # sanity check
+                raise ValueError("unknown vartype")
+
+            samplesets.append(dimod.SampleSet.from_samples_bqm((sample, varorder), bqm=bqm))
+        return samplesets
+
+    def sample_file(self, path, num_reads=1, seed=None, tenure=None, timeout=20,
+                    num_restarts=1000000, energy_threshold=None, num_threads=1,
+                    num_workers=1, max_evaluations=None, cancellation=None,
+                    total_timeout=None, stop_all_on_threshold=False, visited_minima=None,
+                    max_revisits=None):
+        """Run a multistart tabu search on a binary quadratic model stored in
+        a problem file.
+
+        The file, written by :func:`~tabu.problem_file.write_problem_file`,
+        is memory-mapped and searched in place, so no BQM is built in Python
+        and processes sampling the same file share one copy of it.
+
+        Args:
+            path (str or path-like):
+                Path of the problem file.
+
+            num_reads (int, optional, default=1):
+                Number of reads, each starting from a random state.
+
+            Other arguments are as for :meth:`sample`.
+
+        Returns:
+            :class:`~dimod.SampleSet`: A `dimod` :class:`.~dimod.SampleSet`
+            object, in the vartype of the BQM written and with its offset
+            included in the energies. Data vectors and info are as for
+            :meth:`sample`.
+        """
+        stored = read_problem_file(path)
+        n = stored.problem.num_variables
+        if not n:
+            return dimod.SampleSet.from_samples([], energy=0, vartype=stored.vartype)
+
+        if not isinstance(num_reads, int) or num_reads < 1:
+            raise ValueError("'num_reads' should be a positive integer")
+
+        if tenure is None:
+            tenure = min(20, n // 4)
+        elif not isinstance(tenure, int):
+            raise TypeError("'tenure' should be an integer in range [0, num_vars - 1]")
+        elif not 0 <= tenure < n:
+            raise ValueError("'tenure' should be an integer in range [0, num_vars - 1]")
+
+        if timeout is None:
+            timeout = -1
+
+        self._check_stopping(cancellation, total_timeout)
+        self._check_revisits(visited_minima, max_revisits)
+
+        rng = np.random.default_rng(seed)
+        initial_states = rng.integers(2, size=(num_reads, n), dtype=np.int8)
+        seeds = rng.integers(2**32, size=num_reads, dtype=np.uint32)
+
+        start = time.perf_counter()
+        samples, energies, restarts, iterations, evaluations, phase_times, *extra = tabu_search_batch(
+            stored.problem, initial_states, seeds, tenure, timeout, num_restarts,
+            energy_threshold, num_workers, num_threads, max_evaluations,
+            cancellation=cancellation, total_timeout=total_timeout,
+            stop_all_on_threshold=stop_all_on_threshold, visited_minima=visited_minima or 0,
+            max_revisits=-1 if max_revisits is None else max_revisits)
+        info = dict(num_restarts=int(restarts.sum()),
+                    num_iterations=int(iterations.sum()),
+                    num_evaluations=int(evaluations.sum()),
+                    sampling_time=time.perf_counter() - start)
+        if PHASE_TIMING:
+            info.update(phase_times=phase_times)
+
+        vectors = dict(num_restarts=restarts, num_iterations=iterations,
+                       num_evaluations=evaluations)
+        if visited_minima:
+            self._add_revisits(extra.pop(), info, vectors)
+
+        if stored.vartype is dimod.SPIN:
+            samples *= 2
+            samples -= 1
+
+        return dimod.SampleSet.from_samples((samples, stored.variables), stored.vartype,
+                                            energies + stored.offset, info=info, **vectors)
+
+    @staticmethod
+    def _check_stopping(cancellation, total_timeout):
+        """Validate the ``cancellation`` and ``total_timeout`` arguments."""
+        if cancellation is not None and not isinstance(cancellation, Cancellation):
+            raise TypeError("'cancellation' should be a tabu.Cancellation")
+
+        if total_timeout is not None and (
+                not isinstance(total_timeout, int) or total_timeout < 0):
+            raise ValueError("'total_timeout' should be a non-negative integer")
+
+    @staticmethod
+    def _check_revisits(visited_minima, max_revisits):
+        """Validate the ``visited_minima`` and ``max_revisits`` arguments."""
+        if visited_minima is not None and (
+                not isinstance(visited_minima, int) or not 1 <= visited_minima <= 2**30):
+            raise ValueError("'visited_minima' should be an integer in range [1, 2**30]")
+
+        if max_revisits is not None:
+            if not isinstance(max_revisits, int) or max_revisits < 0:
+                raise ValueError("'max_revisits' should be a non-negative integer")
+            if visited_minima is None:
+                raise ValueError("'max_revisits' takes 'visited_minima'")
+
+    @staticmethod
+    def _add_revisits(revisits, info, vectors):
+        """Add the :class:`~tabu.tabu_search.Revisits` of the reads to the
+        info and data vectors of a sample set."""
+        counts = dict(num_minima=revisits.minima, num_revisits=revisits.revisits,
+                      num_revisit_stops=revisits.stops)
+        info.update((name, int(count.sum())) for name, count in counts.items())
+        vectors.update(counts)
+
+    def _prepare(self, bqm):
+        """Return the prepared :class:`~tabu.tabu_search.Problem` of a binary
+        BQM and its variable order.
+
+        The problem is built from the BQM's sparse vectors directly, so memory
+        and time are linear in its size rather than quadratic. Problems are
+        cached on a hash of the BQM contents, so sampling the same BQM again
+        skips building and validating it, while a BQM changed in place is
+        prepared anew. A hit still costs the O(nnz) conversion to vectors and
+        their hash: BQMs keep no version to check, and keying on the object
+        alone would return stale problems for BQMs changed in place.
+        """
+        vectors = bqm.to_numpy_vectors(return_labels=True)
+        ldata, (irow, icol, qdata), _, varorder = vectors
+
+        digest = hashlib.blake2b(digest_size=32)
+        for array in (ldata, irow, icol, qdata):
+            array = np.ascontiguousarray(array)
+            digest.update(array.dtype.str.encode())
+            digest.update(array.tobytes())
+        key = (digest.digest(), tuple(varorder))
+
+        with self._problems_lock:
+            if key in self._problems:
+                self._problems.move_to_end(key)
+                return self._problems[key], varorder
+
+        problem = problem_from_vectors(vectors)
+
+        with self._problems_lock:
+            self._problems[key] = problem
+            while len(self._problems) > self.problem_cache_size:
+                self._problems.popitem(last=False)
+        return problem, varorder
 
     @staticmethod
     def _bqm_to_tabu_qubo(bqm):
+        vectors = bqm.binary.to_numpy_vectors(return_labels=True)
+        return TabuSampler._vectors_to_tabu_qubo(vectors), vectors[-1]
+
+    @staticmethod
+    def _vectors_to_tabu_qubo(vectors):
         # construct dense matrix representation
-        ldata, (irow, icol, qdata), offset, varorder = bqm.binary.to_numpy_vectors(return_labels=True)
-        ud = np.zeros((len(bqm), len(bqm)), dtype=np.double)
-        ud[np.diag_indices(len(bqm), 2)] = ldata
+        ldata, (irow, icol, qdata), offset, varorder = vectors
+
+        # float32 BQMs are searched in single precision, anything else in double
+        dtype = np.result_type(ldata, qdata)
+        if dtype != np.float32:
+            dtype = np.double
+        ud = np.zeros((len(ldata), len(ldata)), dtype=dtype)
+        ud[np.diag_indices(len(ldata), 2)] = ldata
         ud[irow, icol] = qdata
 
         # Note: normally, conversion would be: `ud + ud.T - np.diag(np.diag(ud))`,
         # but the Tabu solver we're using requires slightly different qubo matrix.
         ud *= .5
         symm = ud + ud.T
-        return symm, varorder
+        return symm
@@ -0,0 +1,184 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _BIT_VECTOR_H_
+
+#define _BIT_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bits {
+
+inline int popcount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit of a non-zero word
+inline int lowestSet(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    for (; !(word & 1); word >>= 1) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+}
+
+/**
+ * A binary solution packed 64 variables to a word, variable i in bit i % 64
+ * of word i / 64. Bits past size() are always 0, so whole words can be
+ * compared, counted and XORed.
+ */
+class BitVector
+{
+    public:
+        BitVector() : numBits(0) {}
+
+        /**
+         * Builds a vector of size zeros
+         * @param size: Number of variables
+         */
+        explicit BitVector(int size) : numBits(size), words((size + 63) / 64, 0) {}
+
+        /**
+         * Packs a solution holding one value per variable
+         * @param values: Values, any non-zero value is packed as 1
+         */
+        template <class V>
+        explicit BitVector(const std::vector<V> &values) : BitVector((int)values.size()) {
+            for (int i = 0; i < numBits; i++) {
+                set(i, values[i] != 0);
+            }
+        }
+
+        /**
+         * Packs a solution from an array of one value per variable
+         * @param values: Values, any non-zero value is packed as 1
+         * @param size: Number of variables
+         */
+        template <class V>
+        BitVector(const V *values, int size) : BitVector(size) {
+            for (int i = 0; i < numBits; i++) {
+                set(i, values[i] != 0);
+            }
+        }
+
+        int size() const { return numBits; }
+
+        int operator[](int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+        void set(int i, int value) {
+            std::uint64_t mask = std::uint64_t(1) << (i & 63);
+            words[i >> 6] = value? (words[i >> 6] | mask) : (words[i >> 6] & ~mask);
+        }
+
+        void flip(int i) { words[i >> 6] ^= std::uint64_t(1) << (i & 63); }
+
+        /**
+         * Sets every variable to 0
+         * @return void
+         */
+        void reset() { std::fill(words.begin(), words.end(), 0); }
+
+        /**
+         * Counts the variables set to 1
+         * @return Number of ones
+         */
+        int count() const {
+            int ones = 0;
+            for (std::uint64_t word : words) {
+                ones += bits::popcount(word);
+            }
+            return ones;
+        }
+
+        /**
+         * Counts the variables that differ from another solution of the same size
+         * @param other: Other solution
+         * @return Hamming distance
+         */
+        int distance(const BitVector &other) const {
+            int differ = 0;
+            for (std::size_t w = 0; w < words.size(); w++) {
+                differ += bits::popcount(words[w] ^ other.words[w]);
+            }
+            return differ;
+        }
+
+        /**
+         * Calls f(i) for every variable i set to 1, in increasing order
+         * @param f: Callable taking the variable index
+         * @return void
+         */
+        template <class F>
+        void forEachSet(F f) const {
+            for (std::size_t w = 0; w < words.size(); w++) {
+                for (std::uint64_t word = words[w]; word; word &= word - 1) {
+                    f((int)(w * 64) + bits::lowestSet(word));
+                }
+            }
+        }
+
+        /**
+         * Unpacks the solution into one value per variable
+         * @param out: Output array of size() values, 0 or 1
+         * @return void
+         */
+        template <class V>
+        void unpack(V *out) const {
+            for (int i = 0; i < numBits; i++) {
+                out[i] = (*this)[i];
+            }
+        }
+
+        std::vector<int> toVector() const {
+            std::vector<int> values(numBits);
+            unpack(values.data());
+            return values;
+        }
+
+        /**
+         * Packed words, numWords() of them
+         */
+        const std::uint64_t *data() const { return words.data(); }
+
+        int numWords() const { return (int)words.size(); }
+
+        bool operator==(const BitVector &other) const {
+            return numBits == other.numBits && words == other.words;
+        }
+
+        bool operator!=(const BitVector &other) const { return !(*this == other); }
+
+    private:
+        int numBits;
+        std::vector<std::uint64_t> words;
+};
+
+#endif
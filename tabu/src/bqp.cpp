@@ -14,104 +14,360 @@
 
 #include "bqp.h"
 
-#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <limits>
+#include <type_traits>
+#include <utility>
 
 #include "common.h"
+#include "problem_file.h"
 
 using std::vector;
 
-BQP::BQP(std::vector<std::vector<double>> Q) 
-    : Q(Q), 
-      nVars(Q.size()), 
-      solutionQuality{0},
-      nIterations{0},
-      restartNum{0}, 
-      iterNum{0},  
-      evalNum{0}, 
-      upperBound{-std::numeric_limits<double>::max()} {
-    
+template <class T>
+template <class Matrix>
+void BQP<T>::fromDense(const Matrix &Q) {
+    // First pass validates symmetry and counts the couplings of every row.
+    // For integer T it also bounds every change in objective by the sum of
+    // the absolute values of a row, which must fit in T.
+    offsets.assign(nVars + 1, 0);
+    vector<double> rowBound(std::is_integral<T>::value? nVars : 0);
+    for (int i = 0; i < nVars; i++) {
+        for (int j = i + 1; j < nVars; j++) {
+            auto q = Q(i, j);
+            if (q != Q(j, i)) {
+                throw Exception("Q must be symmetric");
+            }
+            if (q != 0) {
+                offsets[i + 1]++;
+                offsets[j + 1]++;
+                if (!rowBound.empty()) {
+                    rowBound[i] += 2 * std::abs((double)q);
+                    rowBound[j] += 2 * std::abs((double)q);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < (int)rowBound.size(); i++) {
+        if (rowBound[i] + std::abs((double)Q(i, i)) > (double)std::numeric_limits<T>::max()) {
+            throw Exception("Q has coefficients too large for its integer type");
+        }
+    }
+    for (int i = 0; i < nVars; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::size_t nnz = offsets[nVars];
+    dense = nVars > 1 && 2 * nnz >= (std::size_t)nVars * (nVars - 1);
+
+    // Second pass fills the chosen layout, row by row
+    linear.resize(nVars);
+    if (dense) {
+        const int perLine = 64 / sizeof(T);
+        stride = (nVars + perLine - 1) / perLine * perLine;
+        std::vector<int>().swap(offsets);
+        couplings.assign((std::size_t)nVars * stride, 0);
+    }
+    else {
+        neighbors.resize(nnz);
+        couplings.resize(nnz);
+    }
+    for (int i = 0; i < nVars; i++) {
+        int p = dense? 0 : offsets[i];
+        for (int j = 0; j < nVars; j++) {
+            T q = Q(i, j);
+            if (j == i) {
+                linear[i] = q;
+            }
+            else if (dense) {
+                couplings[i * stride + j] = 2 * q;  // Q[i][j] + Q[j][i], Q is symmetric
+            }
+            else if (q != 0) {
+                neighbors[p] = j;
+                couplings[p] = 2 * q;
+                p++;
+            }
+        }
+    }
+    viewStorage();
+}
+
+template <class T>
+void BQP<T>::viewStorage() {
+    linearView = linear.data();
+    offsetsView = offsets.data();
+    neighborsView = neighbors.data();
+    couplingsView = couplings.data();
+    numCouplingValues = couplings.size();
+}
+
+template <class T>
+BQP<T>::BQP(const std::vector<std::vector<double>> &Q) 
+    : nVars(Q.size()), 
+      dense{false},
+      stride{0} {
+
+    PhaseTimer timer(phases, PHASE_CONSTRUCT);
     for (int i = 0; i < nVars; i++) {
         if (Q[i].size() != nVars) {
             throw Exception("Q must be a symmetric square matrix");
         }
-        for (int j = i; j < nVars; j++) {
-            if (Q[i][j] != Q[j][i]) {
-                throw Exception("Q must be symmetric");
+        for (int j = 0; j < nVars; j++) {
+            if (std::is_integral<T>::value && Q[i][j] != std::trunc(Q[i][j])) {
+                throw Exception("Q must have integer coefficients");
             }
         }
     }
+
+    fromDense([&Q](int i, int j) { return Q[i][j]; });
 }
 
-void BQP::initialize(const vector<int> &initSolution) {
-    toUpperTriangular();
+template <class T>
+BQP<T>::BQP(const T *Q, int nRows, int nCols, std::ptrdiff_t rowStride, std::ptrdiff_t colStride)
+    : nVars(nRows), 
+      dense{false},
+      stride{0} {
+
+    PhaseTimer timer(phases, PHASE_CONSTRUCT);
+    if (nRows != nCols) {
+        throw Exception("Q must be a symmetric square matrix");
+    }
 
-    solution = initSolution;
-    solutionQuality = getObjective(solution);
-    nIterations = 1;
+    fromDense([=](int i, int j) { return Q[i * rowStride + j * colStride]; });
 }
 
-void BQP::toUpperTriangular() {
+template <class T>
+BQP<T>::BQP(int nVars, const T *linearBiases, std::size_t numCouplings, const int *irow, const int *icol,
+            const T *values)
+    : nVars(nVars),
+      linear(linearBiases, linearBiases + nVars),
+      dense{false},
+      stride{0} {
+
+    PhaseTimer timer(phases, PHASE_CONSTRUCT);
+
+    // Both directions of every coupling go to the CSR rows, in the order listed
+    offsets.assign(nVars + 1, 0);
+    vector<double> rowBound(std::is_integral<T>::value? nVars : 0);
+    for (std::size_t c = 0; c < numCouplings; c++) {
+        int i = irow[c];
+        int j = icol[c];
+        if (i < 0 || i >= nVars || j < 0 || j >= nVars || i == j) {
+            throw Exception("couplings must join two distinct variables in range");
+        }
+        offsets[i + 1]++;
+        offsets[j + 1]++;
+        if (!rowBound.empty()) {
+            rowBound[i] += std::abs((double)values[c]);
+            rowBound[j] += std::abs((double)values[c]);
+        }
+    }
+    for (int i = 0; i < (int)rowBound.size(); i++) {
+        if (rowBound[i] + std::abs((double)linear[i]) > (double)std::numeric_limits<T>::max()) {
+            throw Exception("Q has coefficients too large for its integer type");
+        }
+    }
     for (int i = 0; i < nVars; i++) {
-        for (int j = i + 1; j < nVars; j++) {
-            Q[i][j] = Q[i][j] + Q[j][i];
-            Q[j][i] = 0;
+        offsets[i + 1] += offsets[i];
+    }
+    vector<std::pair<int, T>> entries(offsets[nVars]);
+    vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t c = 0; c < numCouplings; c++) {
+        entries[next[irow[c]]++] = std::make_pair(icol[c], values[c]);
+        entries[next[icol[c]]++] = std::make_pair(irow[c], values[c]);
+    }
+
+    // Sort every row by neighbour, summing repeated pairs and dropping zeros,
+    // which gives the same rows as the dense constructors
+    std::size_t nnz = 0;
+    for (int i = 0; i < nVars; i++) {
+        auto begin = entries.begin() + offsets[i];
+        auto end = entries.begin() + offsets[i + 1];
+        std::sort(begin, end, [](const std::pair<int, T> &a, const std::pair<int, T> &b) {
+            return a.first < b.first;
+        });
+        offsets[i] = nnz;
+        for (auto p = begin; p != end;) {
+            std::pair<int, T> entry = *p;
+            for (++p; p != end && p->first == entry.first; ++p) {
+                entry.second += p->second;
+            }
+            if (entry.second != 0) {
+                entries[nnz++] = entry;
+            }
         }
     }
+    offsets[nVars] = nnz;
+
+    dense = nVars > 1 && 2 * nnz >= (std::size_t)nVars * (nVars - 1);
+    if (dense) {
+        const int perLine = 64 / sizeof(T);
+        stride = (nVars + perLine - 1) / perLine * perLine;
+        couplings.assign((std::size_t)nVars * stride, 0);
+        for (int i = 0; i < nVars; i++) {
+            for (int p = offsets[i]; p < offsets[i + 1]; p++) {
+                couplings[i * stride + entries[p].first] = entries[p].second;
+            }
+        }
+        std::vector<int>().swap(offsets);
+    }
+    else {
+        neighbors.resize(nnz);
+        couplings.resize(nnz);
+        for (std::size_t p = 0; p < nnz; p++) {
+            neighbors[p] = entries[p].first;
+            couplings[p] = entries[p].second;
+        }
+    }
+    viewStorage();
 }
 
-double BQP::getObjective(const vector<int> &solution) {
-    double cost = 0;
-    vector<int> zeroSolution(nVars, 0);
+template <class T>
+BQP<T>::BQP(std::shared_ptr<const ProblemFile> file)
+    : nVars(file->numVariables()),
+      dense{false},
+      stride{0} {
 
-    for (int i = nVars; i--;) {
-        if (solution[i] == 1) {
-            cost += getChangeInObjective(zeroSolution, i);
-            zeroSolution[i] = 1;
+    PhaseTimer timer(phases, PHASE_CONSTRUCT);
+    if (file->coefficientType() != coefficientTypeOf<T>()) {
+        throw Exception("problem file has a different coefficient type");
+    }
+
+    // One streaming pass validates the sections, so that a corrupt file
+    // cannot make the search read out of bounds
+    const T *linearBiases = file->linear<T>();
+    const int *rowOffsets = file->offsets();
+    const int *columns = file->neighbors();
+    const T *values = file->couplings<T>();
+    if (rowOffsets[0] != 0 || rowOffsets[nVars] != file->numEntries()) {
+        throw Exception("problem file has invalid offsets");
+    }
+    for (int i = 0; i < nVars; i++) {
+        if (rowOffsets[i + 1] < rowOffsets[i]) {
+            throw Exception("problem file has invalid offsets");
+        }
+        double rowBound = std::abs((double)linearBiases[i]);
+        for (int p = rowOffsets[i]; p < rowOffsets[i + 1]; p++) {
+            if (columns[p] < 0 || columns[p] >= nVars || columns[p] == i) {
+                throw Exception("couplings must join two distinct variables in range");
+            }
+            rowBound += std::abs((double)values[p]);
+        }
+        if (std::is_integral<T>::value && rowBound > (double)std::numeric_limits<T>::max()) {
+            throw Exception("Q has coefficients too large for its integer type");
         }
     }
+
+    std::size_t nnz = file->numEntries();
+    dense = nVars > 1 && 2 * nnz >= (std::size_t)nVars * (nVars - 1);
+    if (dense) {
+        linear.assign(linearBiases, linearBiases + nVars);
+        const int perLine = 64 / sizeof(T);
+        stride = (nVars + perLine - 1) / perLine * perLine;
+        couplings.assign((std::size_t)nVars * stride, 0);
+        for (int i = 0; i < nVars; i++) {
+            for (int p = rowOffsets[i]; p < rowOffsets[i + 1]; p++) {
+                couplings[i * stride + columns[p]] += values[p];
+            }
+        }
+        viewStorage();
+        return;
+    }
+
+    linearView = linearBiases;
+    offsetsView = rowOffsets;
+    neighborsView = columns;
+    couplingsView = values;
+    numCouplingValues = nnz;
+    this->file = file;
+}
+
+template <class T>
+double BQP<T>::getObjective(const BitVector &solution) const {
+    double cost = 0;
+
+    // Count every coupling once, from its lower-indexed end. Dense rows are
+    // read at the variables set in the solution only.
+    solution.forEachSet([&](int i) {
+        cost += linearView[i];
+        if (dense) {
+            const T *value = row(i).value;
+            solution.forEachSet([&](int j) {
+                if (j > i) {
+                    cost += value[j];
+                }
+            });
+        }
+        else {
+            forEachNeighbor(i, [&](int j, T coupling) {
+                if (j > i && solution[j] == 1) {
+                    cost += coupling;
+                }
+            });
+        }
+    });
     return cost;
 }
 
-double BQP::getChangeInObjective(const vector<int> &oldSolution, int flippedBit) {
+template <class T>
+T BQP<T>::getChangeInObjective(const BitVector &oldSolution, int flippedBit) const {
     // Add up all biases associated with the variable at flippedBit
-    double change = Q[flippedBit][flippedBit];
-    for (int i = 0; i < nVars; i++) {
-        if ((oldSolution[i] == 1) && (i != flippedBit)) {
-            change += Q[flippedBit][i] + Q[i][flippedBit];
-        }
+    T change = linearView[flippedBit];
+    if (dense) {
+        const T *value = row(flippedBit).value;    // value[flippedBit] == 0
+        oldSolution.forEachSet([&](int j) {
+            change += value[j];
+        });
+    }
+    else {
+        forEachNeighbor(flippedBit, [&](int j, T coupling) {
+            if (oldSolution[j] == 1) {
+                change += coupling;
+            }
+        });
     }
 
     // Flipping to 0 = negative change, flipping to 1 = positive change
     return oldSolution[flippedBit] ? -change : change;
 }
 
-double BQP::getMaxBQPCoeff() {
-    double M = Q[0][0];
+template <class T>
+double BQP<T>::getMaxBQPCoeff() const {
+    // Symmetric Q holds half of each coupling on either side of the diagonal
+    double M = 0;
     for (int i = 0; i < nVars; i++) {
-        for (int j = 0; j < nVars; j++) {
-            if (M < abs(Q[i][j])) {
-                M = abs(Q[i][j]);
-            }
+        if (M < std::abs((double)linearView[i])) {
+            M = std::abs((double)linearView[i]);
+        }
+    }
+    for (size_t p = 0; p < numCouplingValues; p++) {
+        if (M < std::abs((double)couplingsView[p] / 2)) {
+            M = std::abs((double)couplingsView[p] / 2);
         }
     }
     return M;
 }
 
-void BQP::printQ() {
-    printf("BQP: Number of variables: %d\nCoefficient matrix:\n", nVars);
+template <class T>
+void BQP<T>::printQ() const {
+    printf("BQP: Number of variables: %d\nLinear biases and couplings:\n", nVars);
     printf("{\n");
     for (int i = 0; i < nVars; i++) {
-        printf("{");
-        for (int j = 0; j < nVars; j++) {
-            printf("%6f,", Q[i][j]);
-        }
+        printf("%d: %6f {", i, (double)linearView[i]);
+        forEachNeighbor(i, [](int j, T coupling) {
+            if (coupling != 0) {
+                printf("%d: %6f,", j, (double)coupling);
+            }
+        });
         printf("},\n");
     }
     printf("}\n");
 }
 
-void BQP::printSolution() {
+template <class T>
+void BQP<T>::printSolution(const BitVector &solution) const {
     printf("Objective function value: %f\n", getObjective(solution));
     printf("Variable assignment:\n");
     for(int i = 0; i < nVars; i++) {
@@ -119,3 +375,8 @@ void BQP::printSolution() {
     }
     printf("\n");
 }
+
+template class BQP<double>;
+template class BQP<float>;
+template class BQP<std::int32_t>;
+template class BQP<std::int64_t>;
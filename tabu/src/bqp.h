@@ -16,25 +16,92 @@
 
 #define _BQP_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "bit_vector.h"
+#include "common.h"
+#include "phase_timer.h"
+
+class ProblemFile;
+
+/**
+ * Read-only view of the couplings of one variable. A sparse row lists
+ * its neighbours in index, with the couplings at the same positions.
+ * A dense row (index == nullptr) holds one coupling per variable, so
+ * value[j] couples to variable j, and value[i] == 0 on the diagonal.
+ */
+template <class T>
+struct BQPRow {
+    const int *index;
+    const T *value;
+    int size;
+};
+
+/**
+ * A binary quadratic problem, minimize x^T Q x for binary x. Immutable once
+ * constructed, so a single BQP can be shared by any number of searches.
+ *
+ * Coefficients are stored as T, one of double, float, std::int32_t and
+ * std::int64_t (instantiated in bqp.cpp). Integer problems are checked on
+ * construction so that no change in objective of a single flip overflows T.
+ * Objectives are returned as double whatever T is.
+ */
+template <class T>
 class BQP 
 {
     public:
-        BQP(std::vector<std::vector<double>> Q);
+        /**
+         * Builds the problem from a dense Q, whose values must be
+         * representable as T
+         * @param Q: Symmetric square matrix
+         */
+        BQP(const std::vector<std::vector<double>> &Q);
 
         /**
-         * Calls toUpperTriangular() and sets the solution
-         * @return void
+         * Builds the problem directly from a strided dense buffer, such as
+         * the data of a NumPy array, without an intermediate copy of Q
+         * @param Q: Pointer to Q[0][0]
+         * @param nRows: Number of rows of Q
+         * @param nCols: Number of columns of Q
+         * @param rowStride: Distance between Q[i][j] and Q[i + 1][j], in elements
+         * @param colStride: Distance between Q[i][j] and Q[i][j + 1], in elements
          */
-        void initialize(const std::vector<int> &initSolution);
+        BQP(const T *Q, int nRows, int nCols, std::ptrdiff_t rowStride, std::ptrdiff_t colStride);
 
         /**
-         * Converts a generic bqp Q matrix into upper triangular using:
-         * Q[i][j] = Q[i][j] + Q[j][i] for all i < j
-         * @return void
+         * Builds the problem from its linear biases and a list of couplings,
+         * as produced by dimod's BinaryQuadraticModel.to_numpy_vectors(),
+         * without a dense Q. Couplings given more than once, in either order,
+         * are summed. For integer T, the sum of the absolute values of the
+         * couplings of a variable, each listed coupling counted, and of its
+         * linear bias must fit in T.
+         * @param nVars: Number of variables
+         * @param linear: Linear biases, Q[i][i]
+         * @param numCouplings: Number of couplings listed
+         * @param irow: First variable of every coupling
+         * @param icol: Second variable of every coupling, different from the first
+         * @param values: Value of every coupling, Q[i][j] + Q[j][i]
          */
-        void toUpperTriangular();
+        BQP(int nVars, const T *linear, std::size_t numCouplings, const int *irow, const int *icol,
+            const T *values);
+
+        /**
+         * Builds the problem from a problem file (see problem_file.h) of
+         * coefficient type T. Sparse problems are searched in the mapped
+         * file itself, which the BQP keeps open; dense ones are laid out as
+         * a matrix. Offsets and indices are validated, symmetry is not.
+         * @param file: Opened problem file
+         */
+        BQP(std::shared_ptr<const ProblemFile> file);
+
+        // Views may point into the BQP's own storage, which a copy would
+        // not share; moving keeps the buffers and so the views valid
+        BQP(const BQP &) = delete;
+        BQP &operator=(const BQP &) = delete;
+        BQP(BQP &&) = default;
 
         /**
          * Computes the value by which the objective function is changed if
@@ -43,44 +110,116 @@ class BQP
          * @param flippedBit: The bit that is flipped
          * @return Change in objective
          */
-        double getChangeInObjective(const std::vector<int> &oldSolution, int flippedBit);
+        T getChangeInObjective(const BitVector &oldSolution, int flippedBit) const;
 
         /**
          * Computes the value of objective function for a given solution
          * @param solution: Given solution
          * @return Value of objective function
          */
-        double getObjective(const std::vector<int> &solution);
+        double getObjective(const BitVector &solution) const;
         
         /**
-         * Gets the maximum abs(Q[i][j])
-         * @return Maximum Q[i][j]
+         * Gets the couplings of variable i, Q[i][j] + Q[j][i] for all j != i
+         * @param i: Variable index
+         * @return View of the row, valid as long as the BQP
+         */
+        BQPRow<T> row(int i) const {
+            if (dense) {
+                return BQPRow<T>{nullptr, couplingsView + (std::size_t)i * stride, nVars};
+            }
+            return BQPRow<T>{neighborsView + offsetsView[i], couplingsView + offsetsView[i],
+                             offsetsView[i + 1] - offsetsView[i]};
+        }
+
+        /**
+         * Calls f(j, Q[i][j] + Q[j][i]) for the neighbours j of variable i.
+         * Dense rows also visit non-neighbours and i itself, with zero couplings.
+         * @param i: Variable index
+         * @param f: Callable taking (int j, T coupling)
+         * @return void
+         */
+        template <class F>
+        void forEachNeighbor(int i, F f) const {
+            BQPRow<T> r = row(i);
+            if (r.index != nullptr) {
+                for (int p = 0; p < r.size; p++) {
+                    f(r.index[p], r.value[p]);
+                }
+            }
+            else {
+                for (int j = 0; j < r.size; j++) {
+                    f(j, r.value[j]);
+                }
+            }
+        }
+
+        /**
+         * Gets the maximum abs(Q[i][j]) of the symmetric Q matrix
+         * @return Maximum abs(Q[i][j])
          */
-        double getMaxBQPCoeff();
+        double getMaxBQPCoeff() const;
 
         /**
-         * Prints Q matrix
+         * Prints linear biases and the adjacency of the Q matrix
          * @return void
          */
-        void printQ();
+        void printQ() const;
 
         /**
-         * Prints the current solution
+         * Prints a solution and its objective
+         * @param solution: Given solution
          * @return void
          */
-        void printSolution();
+        void printSolution(const BitVector &solution) const;
 
-        std::vector<std::vector<double> > Q;    // Q matrix
+        /**
+         * Q is stored as linear biases (its diagonal) plus the off-diagonal
+         * couplings, Q[i][j] + Q[j][i], in one of two layouts read through row():
+         *  - sparse: compressed sparse row (CSR) form with both directions of
+         *    every coupling stored; the neighbours of variable i are
+         *        neighbors[offsets[i]] ... neighbors[offsets[i + 1] - 1]
+         *    with couplings at the same positions. Zero couplings are not stored.
+         *  - dense: a full symmetric matrix with zero diagonal in couplings,
+         *    row i starting at couplings[i * stride]; offsets and neighbors are
+         *    empty. The stride pads every row to a 64 byte boundary.
+         * The dense layout is used when at least half of the couplings are nonzero.
+         * Q is read through the views, which point either to these vectors or,
+         * for a sparse problem file, into its mapping, the vectors being empty.
+         */
         int nVars;                              // Number of problem variables
-        std::vector<int> solution;              // Current solution, vector of size nVars where every entry is 0 or 1
-        double solutionQuality;                 // Objective function value at solution
-        unsigned long long nIterations;         // Number of iterations required to arrive at solution
-
-        /*added to record more statistics.*/
-        unsigned long long restartNum;  // Number of times simpleTabuSearch runs
-        unsigned long long iterNum;     // Number of times loop within simpleTabuSearch runs
-        unsigned long long evalNum;
-        double upperBound;
+        AlignedVector<T> linear;                // Q[i][i]
+        std::vector<int> offsets;               // CSR row offsets, size nVars + 1
+        std::vector<int> neighbors;             // CSR column indices
+        AlignedVector<T> couplings;             // CSR values or dense rows
+        bool dense;                             // Layout of couplings
+        std::size_t stride;                     // Dense row stride, in elements
+        PhaseTimes phases;                      // Time spent constructing (PHASE_CONSTRUCT)
+
+        const T *linearView;                    // Q[i][i]
+        const int *offsetsView;                 // CSR row offsets
+        const int *neighborsView;               // CSR column indices
+        const T *couplingsView;                 // CSR values or dense rows
+        std::size_t numCouplingValues;          // Length of couplingsView
+        std::shared_ptr<const ProblemFile> file;    // Mapped file the views may point into
+
+
+    private:
+        /**
+         * Validates the symmetry of a dense Q, and for integer T the range
+         * of its values, and fills linear and couplings from it in the layout
+         * that suits its density
+         * @param Q: Callable returning Q[i][j]
+         * @return void
+         */
+        template <class Matrix>
+        void fromDense(const Matrix &Q);
+
+        /**
+         * Points the views at the vectors
+         * @return void
+         */
+        void viewStorage();
 };
 
 #endif
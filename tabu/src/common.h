@@ -18,6 +18,13 @@
 #include <map>
 #include <sstream>
 #include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <malloc.h>
+#endif
 
 class Exception: public std::exception
 {
@@ -33,4 +40,62 @@ class Exception: public std::exception
         std::string error_msg;
 };
 
+/**
+ * Allocator returning memory aligned to Alignment bytes (a cache line by
+ * default), so that buffers and rows can be streamed with aligned loads
+ */
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        AlignedAllocator() noexcept {}
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(std::size_t n) {
+            std::size_t bytes = (n * sizeof(T) > Alignment)? n * sizeof(T) : Alignment;
+            void *p = nullptr;
+#if defined(_WIN32) || defined(_WIN64)
+            p = _aligned_malloc(bytes, Alignment);
+#else
+            if (posix_memalign(&p, Alignment, bytes) != 0) {
+                p = nullptr;
+            }
+#endif
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(p);
+        }
+
+        void deallocate(T *p, std::size_t) noexcept {
+#if defined(_WIN32) || defined(_WIN64)
+            _aligned_free(p);
+#else
+            free(p);
+#endif
+        }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) {
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) {
+    return false;
+}
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
 #endif
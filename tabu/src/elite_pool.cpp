@@ -0,0 +1,63 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#include "elite_pool.h"
+
+#include <algorithm>
+
+#include "common.h"
+
+ElitePool::ElitePool(int capacity, int minDistance) : maxSize(capacity), distance(minDistance) {
+    if (capacity < 0) {
+        throw Exception("elite pool capacity must be non-negative");
+    }
+    if (minDistance < 1) {
+        throw Exception("elite pool minimum distance must be positive");
+    }
+}
+
+bool ElitePool::offer(const BitVector &solution, double energy) {
+    if (maxSize == 0) {
+        return false;
+    }
+
+    // Elites too close to the solution must all be worse, and make way for it
+    bool similar = false;
+    for (const Elite &elite : elites) {
+        if (elite.solution.distance(solution) < distance) {
+            if (elite.energy <= energy) {
+                return false;
+            }
+            similar = true;
+        }
+    }
+    if (similar) {
+        elites.erase(std::remove_if(elites.begin(), elites.end(), [&](const Elite &elite) {
+            return elite.solution.distance(solution) < distance;
+        }), elites.end());
+    }
+    else if ((int)elites.size() == maxSize) {
+        if (elites.back().energy <= energy) {
+            return false;
+        }
+        elites.pop_back();
+    }
+
+    auto position = std::upper_bound(elites.begin(), elites.end(), energy, [](double e, const Elite &elite) {
+        return e < elite.energy;
+    });
+    elites.insert(position, Elite{solution, energy});
+    return true;
+}
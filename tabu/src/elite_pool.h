@@ -0,0 +1,80 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#ifndef _ELITE_POOL_H_
+
+#define _ELITE_POOL_H_
+
+#include <vector>
+
+#include "bit_vector.h"
+
+/**
+ * The best solutions found by a search, kept diverse: any two elites differ
+ * in at least minDistance variables. A solution within minDistance of some
+ * elites enters the pool only if it is better than all of them, and then
+ * replaces them; otherwise it enters if the pool is not full or it is better
+ * than the worst elite, which it replaces. Elites are sorted by energy.
+ */
+class ElitePool
+{
+    public:
+        /**
+         * Builds an empty pool
+         * @param capacity: Maximum number of elites, 0 for a pool that admits nothing
+         * @param minDistance: Minimum Hamming distance between two elites, at least 1
+         */
+        explicit ElitePool(int capacity = 0, int minDistance = 1);
+
+        /**
+         * Offers a solution to the pool
+         * @param solution: Solution
+         * @param energy: Its energy
+         * @return True if the solution entered the pool
+         */
+        bool offer(const BitVector &solution, double energy);
+
+        int size() const { return (int)elites.size(); }
+
+        int capacity() const { return maxSize; }
+
+        int minDistance() const { return distance; }
+
+        /**
+         * Gets an elite
+         * @param k: Rank of the elite, 0 for the best
+         * @return Its solution
+         */
+        const BitVector &solution(int k) const { return elites[k].solution; }
+
+        /**
+         * Gets the energy of an elite
+         * @param k: Rank of the elite, 0 for the best
+         * @return Its energy
+         */
+        double energy(int k) const { return elites[k].energy; }
+
+    private:
+        struct Elite {
+            BitVector solution;
+            double energy;
+        };
+
+        int maxSize;
+        int distance;
+        std::vector<Elite> elites;
+};
+
+#endif
@@ -0,0 +1,381 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "kernels.h"
+
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define TABU_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using std::int32_t;
+using std::int64_t;
+
+namespace {
+
+template <class T>
+void addSignedRowScalar(int n, const T *q, const T *sign, T c, T *delta) {
+    for (int j = 0; j < n; j++) {
+        delta[j] += c * sign[j] * q[j];
+    }
+}
+
+// Scans [begin, n), carrying the minimum found so far in minCost
+template <class T>
+int scanMovesScalar(int begin, int n, const T *delta, const long long *tabooUntil, long long now, double base,
+                    double threshold, double &minCost, long long &numEvaluated) {
+    for (int k = begin; k < n; k++) {
+        if (tabooUntil[k] >= now) {
+            continue;
+        }
+        numEvaluated++;
+        double cost = base + delta[k];
+        if (cost < threshold) {
+            return k;
+        }
+        if (cost < minCost) {
+            minCost = cost;
+        }
+    }
+    return -1;
+}
+
+template <class T>
+int scanMovesScalar(int n, const T *delta, const long long *tabooUntil, long long now, double base, double threshold,
+                    double &minCost, long long &numEvaluated) {
+    minCost = std::numeric_limits<double>::max();
+    return scanMovesScalar(0, n, delta, tabooUntil, now, base, threshold, minCost, numEvaluated);
+}
+
+template <class T>
+int collectTiesScalar(int begin, int n, const T *delta, const long long *tabooUntil, long long now, double base,
+                      double cost, int *ties, int numTies) {
+    for (int k = begin; k < n; k++) {
+        if (tabooUntil[k] < now && base + delta[k] == cost) {
+            ties[numTies++] = k;
+        }
+    }
+    return numTies;
+}
+
+template <class T>
+int collectTiesScalar(int n, const T *delta, const long long *tabooUntil, long long now, double base, double cost,
+                      int *ties) {
+    return collectTiesScalar(0, n, delta, tabooUntil, now, base, cost, ties, 0);
+}
+
+#ifdef TABU_X86_KERNELS
+
+// Row updates, in the native width of every coefficient type
+
+__attribute__((target("avx2")))
+void addSignedRowAVX2(int n, const double *q, const double *sign, double c, double *delta) {
+    __m256d vc = _mm256_set1_pd(c);
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d term = _mm256_mul_pd(_mm256_mul_pd(vc, _mm256_loadu_pd(sign + j)), _mm256_loadu_pd(q + j));
+        _mm256_storeu_pd(delta + j, _mm256_add_pd(_mm256_loadu_pd(delta + j), term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+__attribute__((target("avx2")))
+void addSignedRowAVX2(int n, const float *q, const float *sign, float c, float *delta) {
+    __m256 vc = _mm256_set1_ps(c);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256 term = _mm256_mul_ps(_mm256_mul_ps(vc, _mm256_loadu_ps(sign + j)), _mm256_loadu_ps(q + j));
+        _mm256_storeu_ps(delta + j, _mm256_add_ps(_mm256_loadu_ps(delta + j), term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+__attribute__((target("avx2")))
+void addSignedRowAVX2(int n, const int32_t *q, const int32_t *sign, int32_t c, int32_t *delta) {
+    __m256i vc = _mm256_set1_epi32(c);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256i s = _mm256_mullo_epi32(vc, _mm256_loadu_si256((const __m256i *)(sign + j)));
+        __m256i term = _mm256_mullo_epi32(s, _mm256_loadu_si256((const __m256i *)(q + j)));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(delta + j));
+        _mm256_storeu_si256((__m256i *)(delta + j), _mm256_add_epi32(d, term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+// Four changes in objective, widened to double
+
+__attribute__((target("avx2")))
+inline __m256d load4(const double *delta) {
+    return _mm256_loadu_pd(delta);
+}
+
+__attribute__((target("avx2")))
+inline __m256d load4(const float *delta) {
+    return _mm256_cvtps_pd(_mm_loadu_ps(delta));
+}
+
+__attribute__((target("avx2")))
+inline __m256d load4(const int32_t *delta) {
+    return _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)delta));
+}
+
+// All-ones lanes where tabooUntil[j..j+3] < now
+__attribute__((target("avx2")))
+inline __m256d allowedAVX2(const long long *tabooUntil, __m256i now) {
+    __m256i t = _mm256_loadu_si256((const __m256i *)tabooUntil);
+    return _mm256_castsi256_pd(_mm256_cmpgt_epi64(now, t));
+}
+
+template <class T>
+__attribute__((target("avx2")))
+int scanMovesAVX2(int n, const T *delta, const long long *tabooUntil, long long now, double base, double threshold,
+                  double &minCost, long long &numEvaluated) {
+    __m256i vnow = _mm256_set1_epi64x(now);
+    __m256d vbase = _mm256_set1_pd(base);
+    __m256d vthreshold = _mm256_set1_pd(threshold);
+    __m256d vmin = _mm256_set1_pd(std::numeric_limits<double>::max());
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d cost = _mm256_add_pd(vbase, load4(delta + j));
+        __m256d allowed = allowedAVX2(tabooUntil + j, vnow);
+        int allowedBits = _mm256_movemask_pd(allowed);
+        int belowBits = _mm256_movemask_pd(_mm256_and_pd(allowed, _mm256_cmp_pd(cost, vthreshold, _CMP_LT_OQ)));
+        if (belowBits) {
+            int lane = __builtin_ctz(belowBits);
+            numEvaluated += __builtin_popcount(allowedBits & ((2 << lane) - 1));
+            return j + lane;
+        }
+        numEvaluated += __builtin_popcount(allowedBits);
+        vmin = _mm256_min_pd(vmin, _mm256_blendv_pd(vmin, cost, allowed));
+    }
+    __m128d m = _mm_min_pd(_mm256_castpd256_pd128(vmin), _mm256_extractf128_pd(vmin, 1));
+    minCost = _mm_cvtsd_f64(_mm_min_sd(m, _mm_unpackhi_pd(m, m)));
+    return scanMovesScalar(j, n, delta, tabooUntil, now, base, threshold, minCost, numEvaluated);
+}
+
+template <class T>
+__attribute__((target("avx2")))
+int collectTiesAVX2(int n, const T *delta, const long long *tabooUntil, long long now, double base, double cost,
+                    int *ties) {
+    __m256i vnow = _mm256_set1_epi64x(now);
+    __m256d vbase = _mm256_set1_pd(base);
+    __m256d vcost = _mm256_set1_pd(cost);
+    int numTies = 0;
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d equal = _mm256_cmp_pd(_mm256_add_pd(vbase, load4(delta + j)), vcost, _CMP_EQ_OQ);
+        for (int bits = _mm256_movemask_pd(_mm256_and_pd(equal, allowedAVX2(tabooUntil + j, vnow))); bits; bits &= bits - 1) {
+            ties[numTies++] = j + __builtin_ctz(bits);
+        }
+    }
+    return collectTiesScalar(j, n, delta, tabooUntil, now, base, cost, ties, numTies);
+}
+
+__attribute__((target("avx512f")))
+void addSignedRowAVX512(int n, const double *q, const double *sign, double c, double *delta) {
+    __m512d vc = _mm512_set1_pd(c);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m512d term = _mm512_mul_pd(_mm512_mul_pd(vc, _mm512_loadu_pd(sign + j)), _mm512_loadu_pd(q + j));
+        _mm512_storeu_pd(delta + j, _mm512_add_pd(_mm512_loadu_pd(delta + j), term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+__attribute__((target("avx512f")))
+void addSignedRowAVX512(int n, const float *q, const float *sign, float c, float *delta) {
+    __m512 vc = _mm512_set1_ps(c);
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m512 term = _mm512_mul_ps(_mm512_mul_ps(vc, _mm512_loadu_ps(sign + j)), _mm512_loadu_ps(q + j));
+        _mm512_storeu_ps(delta + j, _mm512_add_ps(_mm512_loadu_ps(delta + j), term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+__attribute__((target("avx512f")))
+void addSignedRowAVX512(int n, const int32_t *q, const int32_t *sign, int32_t c, int32_t *delta) {
+    __m512i vc = _mm512_set1_epi32(c);
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m512i term = _mm512_mullo_epi32(_mm512_mullo_epi32(vc, _mm512_loadu_si512(sign + j)), _mm512_loadu_si512(q + j));
+        _mm512_storeu_si512(delta + j, _mm512_add_epi32(_mm512_loadu_si512(delta + j), term));
+    }
+    addSignedRowScalar(n - j, q + j, sign + j, c, delta + j);
+}
+
+// Eight changes in objective, widened to double (the zero-masked conversions
+// avoid spurious maybe-uninitialized warnings from GCC)
+
+__attribute__((target("avx512f")))
+inline __m512d load8(const double *delta) {
+    return _mm512_loadu_pd(delta);
+}
+
+__attribute__((target("avx512f")))
+inline __m512d load8(const float *delta) {
+    return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(delta));
+}
+
+__attribute__((target("avx512f")))
+inline __m512d load8(const int32_t *delta) {
+    return _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256((const __m256i *)delta));
+}
+
+// Lanes where tabooUntil[j..j+7] < now
+__attribute__((target("avx512f")))
+inline __mmask8 allowedAVX512(const long long *tabooUntil, __m512i now) {
+    return _mm512_cmplt_epi64_mask(_mm512_loadu_si512(tabooUntil), now);
+}
+
+template <class T>
+__attribute__((target("avx512f")))
+int scanMovesAVX512(int n, const T *delta, const long long *tabooUntil, long long now, double base, double threshold,
+                    double &minCost, long long &numEvaluated) {
+    __m512i vnow = _mm512_set1_epi64(now);
+    __m512d vbase = _mm512_set1_pd(base);
+    __m512d vthreshold = _mm512_set1_pd(threshold);
+    __m512d vmin = _mm512_set1_pd(std::numeric_limits<double>::max());
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m512d cost = _mm512_add_pd(vbase, load8(delta + j));
+        __mmask8 allowed = allowedAVX512(tabooUntil + j, vnow);
+        __mmask8 below = _mm512_mask_cmp_pd_mask(allowed, cost, vthreshold, _CMP_LT_OQ);
+        if (below) {
+            int lane = __builtin_ctz(below);
+            numEvaluated += __builtin_popcount(allowed & ((2 << lane) - 1));
+            return j + lane;
+        }
+        numEvaluated += __builtin_popcount(allowed);
+        vmin = _mm512_mask_min_pd(vmin, allowed, vmin, cost);
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, vmin);
+    minCost = lanes[0];
+    for (int k = 1; k < 8; k++) {
+        minCost = (lanes[k] < minCost)? lanes[k] : minCost;
+    }
+    return scanMovesScalar(j, n, delta, tabooUntil, now, base, threshold, minCost, numEvaluated);
+}
+
+template <class T>
+__attribute__((target("avx512f")))
+int collectTiesAVX512(int n, const T *delta, const long long *tabooUntil, long long now, double base, double cost,
+                      int *ties) {
+    __m512i vnow = _mm512_set1_epi64(now);
+    __m512d vbase = _mm512_set1_pd(base);
+    __m512d vcost = _mm512_set1_pd(cost);
+    int numTies = 0;
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m512d sum = _mm512_add_pd(vbase, load8(delta + j));
+        for (int bits = _mm512_mask_cmp_pd_mask(allowedAVX512(tabooUntil + j, vnow), sum, vcost, _CMP_EQ_OQ); bits; bits &= bits - 1) {
+            ties[numTies++] = j + __builtin_ctz(bits);
+        }
+    }
+    return collectTiesScalar(j, n, delta, tabooUntil, now, base, cost, ties, numTies);
+}
+
+#endif
+
+enum InstructionSet { SCALAR, AVX2, AVX512 };
+
+InstructionSet detectInstructionSet() {
+#ifdef TABU_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+#endif
+    return SCALAR;
+}
+
+const InstructionSet instructionSet = detectInstructionSet();
+
+template <class T>
+struct Kernels {
+    void (*addSignedRow)(int, const T *, const T *, T, T *);
+    int (*scanMoves)(int, const T *, const long long *, long long, double, double, double &, long long &);
+    int (*collectTies)(int, const T *, const long long *, long long, double, double, int *);
+};
+
+template <class T>
+Kernels<T> selectKernels() {
+#ifdef TABU_X86_KERNELS
+    if (instructionSet == AVX512) {
+        return Kernels<T>{addSignedRowAVX512, scanMovesAVX512<T>, collectTiesAVX512<T>};
+    }
+    if (instructionSet == AVX2) {
+        return Kernels<T>{addSignedRowAVX2, scanMovesAVX2<T>, collectTiesAVX2<T>};
+    }
+#endif
+    return Kernels<T>{addSignedRowScalar<T>, scanMovesScalar<T>, collectTiesScalar<T>};
+}
+
+// 64-bit integers need AVX-512DQ to multiply or convert to double, so they use the scalar loops everywhere
+template <>
+Kernels<int64_t> selectKernels<int64_t>() {
+    return Kernels<int64_t>{addSignedRowScalar<int64_t>, scanMovesScalar<int64_t>, collectTiesScalar<int64_t>};
+}
+
+template <class T>
+const Kernels<T> &kernels() {
+    static const Kernels<T> selected = selectKernels<T>();
+    return selected;
+}
+
+}
+
+template <class T>
+void addSignedRow(int n, const T *q, const T *sign, T c, T *delta) {
+    kernels<T>().addSignedRow(n, q, sign, c, delta);
+}
+
+template <class T>
+int scanMoves(int n, const T *delta, const long long *tabooUntil, long long now, double base, double threshold,
+              double &minCost, long long &numEvaluated) {
+    return kernels<T>().scanMoves(n, delta, tabooUntil, now, base, threshold, minCost, numEvaluated);
+}
+
+template <class T>
+int collectTies(int n, const T *delta, const long long *tabooUntil, long long now, double base, double cost, int *ties) {
+    return kernels<T>().collectTies(n, delta, tabooUntil, now, base, cost, ties);
+}
+
+const char *kernelInstructionSet() {
+    switch (instructionSet) {
+        case AVX512:
+            return "avx512";
+        case AVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+#define INSTANTIATE_KERNELS(T) \
+    template void addSignedRow<T>(int, const T *, const T *, T, T *); \
+    template int scanMoves<T>(int, const T *, const long long *, long long, double, double, double &, long long &); \
+    template int collectTies<T>(int, const T *, const long long *, long long, double, double, int *);
+
+INSTANTIATE_KERNELS(double)
+INSTANTIATE_KERNELS(float)
+INSTANTIATE_KERNELS(int32_t)
+INSTANTIATE_KERNELS(int64_t)
@@ -0,0 +1,78 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _KERNELS_H_
+
+#define _KERNELS_H_
+
+#include <cstdint>
+
+// Inner loops of the tabu search, for every coefficient type T of BQP<T>
+// (double, float, std::int32_t and std::int64_t). Each kernel has a scalar
+// implementation and, on x86-64 with GCC or Clang, AVX2 and AVX-512 ones
+// selected at run time from the CPU features, except for std::int64_t which
+// is always scalar. All implementations return identical results.
+
+/**
+ * Adds c * sign[j] * q[j] to delta[j] for all j in [0, n). With sign[j] and c
+ * in {-1, 1} every term is exactly +-q[j].
+ * @param n: Length of the arrays
+ * @param q: Row of couplings
+ * @param sign: 1 - 2 * solution[j]
+ * @param c: -sign of the flipped variable
+ * @param delta: Changes in objective to update
+ * @return void
+ */
+template <class T>
+void addSignedRow(int n, const T *q, const T *sign, T c, T *delta);
+
+/**
+ * Scans the moves of one tabu search iteration, in index order. Flipping j
+ * costs base + delta[j], in double, and is allowed if tabooUntil[j] < now.
+ * @param n: Length of the arrays
+ * @param delta: Change in objective of flipping every variable
+ * @param tabooUntil: Last iteration at which every variable is tabu
+ * @param now: Current iteration
+ * @param base: Current objective
+ * @param threshold: Cost below which a move is taken at once
+ * @param minCost: Set to the lowest cost of the allowed moves if no move is
+ *                 below threshold, max double if no move is allowed
+ * @param numEvaluated: Incremented by the number of allowed moves scanned
+ * @return First allowed j with cost below threshold, -1 if there is none
+ */
+template <class T>
+int scanMoves(int n, const T *delta, const long long *tabooUntil, long long now, double base, double threshold,
+              double &minCost, long long &numEvaluated);
+
+/**
+ * Collects the allowed moves of cost exactly cost (see scanMoves())
+ * @param n: Length of the arrays
+ * @param delta: Change in objective of flipping every variable
+ * @param tabooUntil: Last iteration at which every variable is tabu
+ * @param now: Current iteration
+ * @param base: Current objective
+ * @param cost: Cost to match
+ * @param ties: Storage for at least n indices, filled in increasing order
+ * @return Number of ties
+ */
+template <class T>
+int collectTies(int n, const T *delta, const long long *tabooUntil, long long now, double base, double cost, int *ties);
+
+/**
+ * Gets the instruction set the kernels run on
+ * @return "avx512", "avx2" or "scalar"
+ */
+const char *kernelInstructionSet();
+
+#endif
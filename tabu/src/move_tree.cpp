@@ -0,0 +1,139 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "move_tree.h"
+
+#include <cstdint>
+#include <limits>
+
+using std::vector;
+
+namespace {
+const double INF = std::numeric_limits<double>::infinity();
+}
+
+template <class V>
+MoveTree::MoveTree(const vector<V> &values) {
+    size = 1;
+    while (size < (int)values.size()) {
+        size *= 2;
+    }
+    minv.resize(2 * size);
+    count.resize(2 * size);
+    allowed.resize(2 * size);
+    reset(values);
+}
+
+template <class V>
+void MoveTree::reset(const vector<V> &values) {
+    for (int i = 0; i < size; i++) {
+        bool valid = i < (int)values.size();
+        minv[size + i] = valid? values[i] : INF;
+        count[size + i] = valid;
+        allowed[size + i] = valid;
+    }
+    for (int node = size - 1; node >= 1; node--) {
+        pull(node);
+    }
+}
+
+void MoveTree::update(int i, double value) {
+    int node = size + i;
+    if (allowed[node] == 0) {
+        return;
+    }
+    minv[node] = value;
+    for (node /= 2; node >= 1; node /= 2) {
+        pull(node);
+    }
+}
+
+void MoveTree::setTaboo(int i) {
+    int node = size + i;
+    minv[node] = INF;
+    count[node] = 0;
+    allowed[node] = 0;
+    for (node /= 2; node >= 1; node /= 2) {
+        pull(node);
+    }
+}
+
+void MoveTree::clearTaboo(int i, double value) {
+    int node = size + i;
+    minv[node] = value;
+    count[node] = 1;
+    allowed[node] = 1;
+    for (node /= 2; node >= 1; node /= 2) {
+        pull(node);
+    }
+}
+
+int MoveTree::findMin(int r) const {
+    int node = 1;
+    while (node < size) {
+        int left = 2 * node;
+        int c = (minv[left] == minv[node])? count[left] : 0;
+        if (r < c) {
+            node = left;
+        }
+        else {
+            r -= c;
+            node = left + 1;
+        }
+    }
+    return node - size;
+}
+
+int MoveTree::firstBelow(double base, double threshold) const {
+    // base + v is nondecreasing in v, also after rounding, so a subtree holds
+    // a move below threshold if and only if its minimum is one
+    if (!(base + minv[1] < threshold)) {
+        return -1;
+    }
+    int node = 1;
+    while (node < size) {
+        node = (base + minv[2 * node] < threshold)? 2 * node : 2 * node + 1;
+    }
+    return node - size;
+}
+
+int MoveTree::countAllowed(int end) const {
+    int total = 0;
+    for (int l = size, r = size + end; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            total += allowed[l++];
+        }
+        if (r & 1) {
+            total += allowed[--r];
+        }
+    }
+    return total;
+}
+
+void MoveTree::pull(int node) {
+    int left = 2 * node, right = left + 1;
+    double m = (minv[left] < minv[right])? minv[left] : minv[right];
+    minv[node] = m;
+    count[node] = ((minv[left] == m)? count[left] : 0) + ((minv[right] == m)? count[right] : 0);
+    allowed[node] = allowed[left] + allowed[right];
+}
+
+#define INSTANTIATE_MOVE_TREE(V) \
+    template MoveTree::MoveTree(const vector<V> &values); \
+    template void MoveTree::reset(const vector<V> &values);
+
+INSTANTIATE_MOVE_TREE(double)
+INSTANTIATE_MOVE_TREE(float)
+INSTANTIATE_MOVE_TREE(std::int32_t)
+INSTANTIATE_MOVE_TREE(std::int64_t)
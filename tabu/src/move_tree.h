@@ -0,0 +1,112 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _MOVE_TREE_H_
+
+#define _MOVE_TREE_H_
+
+#include <vector>
+
+/**
+ * Segment tree over the change in objective of every one-flip move, for
+ * selecting the best non-taboo move of sparse problems in O(log n) rather
+ * than scanning all variables. Taboo moves are masked out of the tree, and
+ * ties are resolved in index order like the linear scan.
+ */
+class MoveTree
+{
+    public:
+        /**
+         * Builds the tree with all moves allowed
+         * @param values: Change in objective of every move, of any
+         *                coefficient type of BQP
+         */
+        template <class V>
+        explicit MoveTree(const std::vector<V> &values);
+
+        /**
+         * Sets the value of every move and allows all of them
+         * @param values: Change in objective of every move
+         * @return void
+         */
+        template <class V>
+        void reset(const std::vector<V> &values);
+
+        /**
+         * Sets the value of a move, ignored while it is taboo
+         * @param i: Move index
+         * @param value: Change in objective
+         * @return void
+         */
+        void update(int i, double value);
+
+        /**
+         * Masks a move out of the tree
+         * @param i: Move index
+         * @return void
+         */
+        void setTaboo(int i);
+
+        /**
+         * Allows a move again
+         * @param i: Move index
+         * @param value: Change in objective
+         * @return void
+         */
+        void clearTaboo(int i, double value);
+
+        /**
+         * Gets the lowest value of the allowed moves
+         * @return Lowest value, infinity if no move is allowed
+         */
+        double minValue() const { return minv[1]; }
+
+        /**
+         * Gets the number of allowed moves with the lowest value
+         * @return Number of ties, 0 if no move is allowed
+         */
+        int minCount() const { return count[1]; }
+
+        /**
+         * Gets the allowed move of lowest value with rank r in index order
+         * @param r: Rank, in [0, minCount())
+         * @return Move index
+         */
+        int findMin(int r) const;
+
+        /**
+         * Gets the first allowed move i with base + value[i] < threshold
+         * @param base: Current objective
+         * @param threshold: Bound on the objective after the move
+         * @return Move index, -1 if there is none
+         */
+        int firstBelow(double base, double threshold) const;
+
+        /**
+         * Counts the allowed moves in [0, end)
+         * @param end: End of the range
+         * @return Number of allowed moves
+         */
+        int countAllowed(int end) const;
+
+    private:
+        void pull(int node);
+
+        int size;                       // Number of leaves, a power of two
+        std::vector<double> minv;       // Lowest allowed value in the subtree
+        std::vector<int> count;         // Number of allowed leaves holding minv
+        std::vector<int> allowed;       // Number of allowed leaves
+};
+
+#endif
@@ -0,0 +1,151 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _PHASE_TIMER_H_
+
+#define _PHASE_TIMER_H_
+
+#include <chrono>
+
+// Per-phase timing of the search, compiled in by defining TABU_PHASE_TIMING.
+// Otherwise PhaseTimer is empty and every count stays 0.
+#if defined(TABU_PHASE_TIMING) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define TABU_PHASE_TIMING_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+enum Phase {
+    PHASE_CONSTRUCT,            // BQP construction and validation
+    PHASE_INITIALIZE,           // Setup of simpleTabuSearch: changes in objective, move tree
+    PHASE_COMPUTE_C,            // computeCDiagonal
+    PHASE_SELECT_VARIABLES,     // selectVariables
+    PHASE_STEEPEST_ASCENT,      // steepestAscent
+    PHASE_TABU_LOOP,            // Iterations of simpleTabuSearch
+    PHASE_LOCAL_SEARCH,         // localSearchInternal
+    PHASE_PATH_RELINK,          // relink
+    NUM_PHASES
+};
+
+inline bool phaseTimingEnabled() {
+#ifdef TABU_PHASE_TIMING
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline const char *phaseName(int phase) {
+    static const char *const names[NUM_PHASES] = {
+        "construct", "initialize", "compute_c", "select_variables",
+        "steepest_ascent", "tabu_loop", "local_search", "path_relink"
+    };
+    return names[phase];
+}
+
+// Timestamp counter where available, else the monotonic clock in nanoseconds
+inline unsigned long long readTicks() {
+#ifdef TABU_PHASE_TIMING_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Rate of readTicks(), the TSC being calibrated against the monotonic clock on first use
+inline double ticksPerSecond() {
+#ifdef TABU_PHASE_TIMING_TSC
+    static const double rate = []() {
+        auto start = std::chrono::steady_clock::now();
+        unsigned long long startTicks = readTicks();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(10)) {}
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return (readTicks() - startTicks) / seconds;
+    }();
+    return rate;
+#else
+    return 1e9;
+#endif
+}
+
+/**
+ * Ticks and number of calls accumulated per phase. The time of a phase
+ * excludes the phases timed while it runs, e.g. the tabu loop excludes the
+ * local searches it starts.
+ */
+struct PhaseTimes {
+    unsigned long long ticks[NUM_PHASES] = {};
+    unsigned long long calls[NUM_PHASES] = {};
+
+    double seconds(int phase) const { return ticks[phase] / ticksPerSecond(); }
+
+    unsigned long long count(int phase) const { return calls[phase]; }
+
+    unsigned long long totalTicks() const {
+        unsigned long long total = 0;
+        for (int p = 0; p < NUM_PHASES; p++) {
+            total += ticks[p];
+        }
+        return total;
+    }
+
+    void add(const PhaseTimes &other) {
+        for (int p = 0; p < NUM_PHASES; p++) {
+            ticks[p] += other.ticks[p];
+            calls[p] += other.calls[p];
+        }
+    }
+};
+
+/**
+ * Adds the time from its construction to stop() or its destruction to a
+ * phase of a PhaseTimes, owned by one thread. Does nothing unless
+ * TABU_PHASE_TIMING is defined.
+ */
+class PhaseTimer {
+    public:
+#ifdef TABU_PHASE_TIMING
+        PhaseTimer(PhaseTimes &times, Phase phase)
+            : times(times), phase(phase), nested(times.totalTicks()), start(readTicks()), running(true) {}
+
+        ~PhaseTimer() { stop(); }
+
+        void stop() {
+            if (running) {
+                unsigned long long elapsed = readTicks() - start;
+                unsigned long long inner = times.totalTicks() - nested;
+                times.ticks[phase] += (elapsed > inner)? elapsed - inner : 0;
+                times.calls[phase]++;
+                running = false;
+            }
+        }
+
+    private:
+        PhaseTimes &times;
+        Phase phase;
+        unsigned long long nested;      // totalTicks() at start, to subtract the phases timed meanwhile
+        unsigned long long start;
+        bool running;
+#else
+        PhaseTimer(PhaseTimes &, Phase) {}
+
+        void stop() {}
+#endif
+};
+
+#endif
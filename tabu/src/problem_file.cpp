@@ -0,0 +1,207 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "problem_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+
+using std::vector;
+
+const char PROBLEM_FILE_MAGIC[8] = {'T', 'A', 'B', 'U', 'B', 'Q', 'P', '\0'};
+
+namespace {
+
+std::size_t coefficientSize(std::uint32_t type) {
+    switch (type) {
+        case COEFFICIENT_DOUBLE: return sizeof(double);
+        case COEFFICIENT_FLOAT: return sizeof(float);
+        case COEFFICIENT_INT32: return sizeof(std::int32_t);
+        case COEFFICIENT_INT64: return sizeof(std::int64_t);
+        default: return 0;
+    }
+}
+
+// Next multiple of 64, the alignment of the sections
+std::uint64_t alignSection(std::uint64_t offset) {
+    return (offset + 63) / 64 * 64;
+}
+
+// Whether the section of count elements of the given size at offset is aligned and in the file
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::size_t elementSize, std::size_t fileSize) {
+    return offset % 64 == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+}
+
+ProblemFile::ProblemFile(const std::string &path)
+    : data(nullptr),
+      size(0) {
+#if defined(_WIN32) || defined(_WIN64)
+    mapping = nullptr;
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw Exception("cannot open problem file " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(handle, &fileSize) && fileSize.QuadPart >= (LONGLONG)sizeof(ProblemFileHeader)) {
+        size = fileSize.QuadPart;
+        mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    CloseHandle(handle);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw Exception("cannot open problem file " + path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size >= (off_t)sizeof(ProblemFileHeader)) {
+        size = status.st_size;
+        void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            data = (const char *)address;
+        }
+    }
+    close(fd);
+#endif
+    if (data == nullptr) {
+        unmap();
+        throw Exception("cannot map problem file " + path);
+    }
+
+    const ProblemFileHeader &h = header();
+    std::size_t valueSize = coefficientSize(h.coefficientType);
+    bool valid = memcmp(h.magic, PROBLEM_FILE_MAGIC, sizeof(h.magic)) == 0 &&
+                 h.version == PROBLEM_FILE_VERSION && valueSize != 0 &&
+                 h.numVariables >= 0 && h.numVariables < std::numeric_limits<int>::max() &&
+                 h.numEntries >= 0 && h.numEntries <= std::numeric_limits<int>::max() &&
+                 sectionFits(h.linearOffset, h.numVariables, valueSize, size) &&
+                 sectionFits(h.offsetsOffset, h.numVariables + 1, sizeof(int), size) &&
+                 sectionFits(h.neighborsOffset, h.numEntries, sizeof(int), size) &&
+                 sectionFits(h.couplingsOffset, h.numEntries, valueSize, size) &&
+                 h.labelsOffset <= size && h.labelsSize <= size - h.labelsOffset;
+    if (!valid) {
+        unmap();
+        throw Exception("not a valid problem file: " + path);
+    }
+}
+
+ProblemFile::~ProblemFile() {
+    unmap();
+}
+
+void ProblemFile::unmap() {
+#if defined(_WIN32) || defined(_WIN64)
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    mapping = nullptr;
+#else
+    if (data != nullptr) {
+        munmap((void *)data, size);
+    }
+#endif
+    data = nullptr;
+}
+
+template <class T>
+void writeProblemFile(const std::string &path, const BQP<T> &bqp, const std::string &labels) {
+    int n = bqp.nVars;
+
+    // Rows in CSR form, skipping the zeros of dense rows. Offsets are int, as
+    // in the file, so a problem with more entries cannot be written.
+    vector<int> offsets(n + 1, 0);
+    vector<int> neighbors;
+    vector<T> couplings;
+    for (int i = 0; i < n; i++) {
+        bqp.forEachNeighbor(i, [&](int j, T coupling) {
+            if (coupling != 0) {
+                neighbors.push_back(j);
+                couplings.push_back(coupling);
+            }
+        });
+        if (neighbors.size() > (std::size_t)std::numeric_limits<int>::max()) {
+            throw Exception("problem has too many couplings for a problem file: " + path);
+        }
+        offsets[i + 1] = (int)neighbors.size();
+    }
+
+    ProblemFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, PROBLEM_FILE_MAGIC, sizeof(h.magic));
+    h.version = PROBLEM_FILE_VERSION;
+    h.coefficientType = coefficientTypeOf<T>();
+    h.numVariables = n;
+    h.numEntries = (std::int64_t)neighbors.size();
+    h.linearOffset = alignSection(sizeof(h));
+    h.offsetsOffset = alignSection(h.linearOffset + n * sizeof(T));
+    h.neighborsOffset = alignSection(h.offsetsOffset + (n + 1) * sizeof(int));
+    h.couplingsOffset = alignSection(h.neighborsOffset + neighbors.size() * sizeof(int));
+    h.labelsOffset = alignSection(h.couplingsOffset + couplings.size() * sizeof(T));
+    h.labelsSize = labels.size();
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        throw Exception("cannot create problem file " + path);
+    }
+    std::uint64_t written = 0;
+    bool ok = true;
+    auto write = [&](std::uint64_t offset, const void *section, std::size_t bytes) {
+        static const char padding[64] = {};
+        if (ok && offset > written) {
+            ok = fwrite(padding, 1, offset - written, file) == offset - written;
+        }
+        if (ok && bytes) {
+            ok = fwrite(section, 1, bytes, file) == bytes;
+        }
+        written = offset + bytes;
+    };
+    write(0, &h, sizeof(h));
+    write(h.linearOffset, bqp.linearView, n * sizeof(T));
+    write(h.offsetsOffset, offsets.data(), offsets.size() * sizeof(int));
+    write(h.neighborsOffset, neighbors.data(), neighbors.size() * sizeof(int));
+    write(h.couplingsOffset, couplings.data(), couplings.size() * sizeof(T));
+    write(h.labelsOffset, labels.data(), labels.size());
+    if (fclose(file) != 0 || !ok) {
+        throw Exception("cannot write problem file " + path);
+    }
+}
+
+#define INSTANTIATE_PROBLEM_FILE(T) \
+    template void writeProblemFile<T>(const std::string &, const BQP<T> &, const std::string &);
+
+INSTANTIATE_PROBLEM_FILE(double)
+INSTANTIATE_PROBLEM_FILE(float)
+INSTANTIATE_PROBLEM_FILE(std::int32_t)
+INSTANTIATE_PROBLEM_FILE(std::int64_t)
@@ -0,0 +1,143 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _PROBLEM_FILE_H_
+
+#define _PROBLEM_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bqp.h"
+
+/**
+ * Problem files hold a BQP in a form that is searched in place once the
+ * file is memory-mapped, so processes loading the same file share one
+ * page-cached copy and start without parsing. The file is, in native byte
+ * order (a file from a host of the other order fails the version check):
+ *  - a ProblemFileHeader
+ *  - linear biases, numVariables values of the coefficient type
+ *  - CSR row offsets, numVariables + 1 int32 values
+ *  - CSR column indices, numEntries int32 values
+ *  - CSR couplings Q[i][j] + Q[j][i], numEntries values of the coefficient type
+ *  - optionally labels, labelsSize bytes left to the writer, e.g. the
+ *    variable labels of a BQM
+ * with every coupling stored in both directions, and every section starting
+ * at a multiple of 64 bytes from the start of the file.
+ */
+
+enum CoefficientType : std::uint32_t {
+    COEFFICIENT_DOUBLE,
+    COEFFICIENT_FLOAT,
+    COEFFICIENT_INT32,
+    COEFFICIENT_INT64
+};
+
+template <class T>
+CoefficientType coefficientTypeOf();
+
+template <> inline CoefficientType coefficientTypeOf<double>() { return COEFFICIENT_DOUBLE; }
+template <> inline CoefficientType coefficientTypeOf<float>() { return COEFFICIENT_FLOAT; }
+template <> inline CoefficientType coefficientTypeOf<std::int32_t>() { return COEFFICIENT_INT32; }
+template <> inline CoefficientType coefficientTypeOf<std::int64_t>() { return COEFFICIENT_INT64; }
+
+struct ProblemFileHeader {
+    char magic[8];                      // PROBLEM_FILE_MAGIC
+    std::uint32_t version;              // PROBLEM_FILE_VERSION
+    std::uint32_t coefficientType;      // CoefficientType
+    std::int64_t numVariables;
+    std::int64_t numEntries;            // CSR entries, twice the number of couplings
+    std::uint64_t linearOffset;         // Byte offsets of the sections
+    std::uint64_t offsetsOffset;
+    std::uint64_t neighborsOffset;
+    std::uint64_t couplingsOffset;
+    std::uint64_t labelsOffset;
+    std::uint64_t labelsSize;           // 0 without labels
+};
+
+extern const char PROBLEM_FILE_MAGIC[8];
+const std::uint32_t PROBLEM_FILE_VERSION = 1;
+
+/**
+ * A problem file mapped read-only into memory, with its header and section
+ * bounds validated. Unmapped on destruction, so BQPs built from it hold it
+ * through a shared_ptr.
+ */
+class ProblemFile
+{
+    public:
+        /**
+         * Maps a problem file
+         * @param path: Path of the file
+         */
+        explicit ProblemFile(const std::string &path);
+
+        ~ProblemFile();
+
+        ProblemFile(const ProblemFile &) = delete;
+        ProblemFile &operator=(const ProblemFile &) = delete;
+
+        CoefficientType coefficientType() const { return (CoefficientType)header().coefficientType; }
+
+        int numVariables() const { return (int)header().numVariables; }
+
+        int numEntries() const { return (int)header().numEntries; }
+
+        template <class T>
+        const T *linear() const { return (const T *)(data + header().linearOffset); }
+
+        const int *offsets() const { return (const int *)(data + header().offsetsOffset); }
+
+        const int *neighbors() const { return (const int *)(data + header().neighborsOffset); }
+
+        template <class T>
+        const T *couplings() const { return (const T *)(data + header().couplingsOffset); }
+
+        /**
+         * Gets the labels stored by the writer
+         * @return Labels, empty if none
+         */
+        std::string labels() const {
+            return std::string(data + header().labelsOffset, header().labelsSize);
+        }
+
+    private:
+        const ProblemFileHeader &header() const { return *(const ProblemFileHeader *)data; }
+
+        /**
+         * Releases the mapping, if any
+         * @return void
+         */
+        void unmap();
+
+        const char *data;
+        std::size_t size;
+#if defined(_WIN32) || defined(_WIN64)
+        void *mapping;
+#endif
+};
+
+/**
+ * Writes a problem to a problem file in CSR form, whatever its layout,
+ * leaving out zero couplings
+ * @param path: Path of the file, replaced if it exists
+ * @param bqp: Problem
+ * @param labels: Bytes stored as labels, may be empty
+ * @return void
+ */
+template <class T>
+void writeProblemFile(const std::string &path, const BQP<T> &bqp, const std::string &labels);
+
+#endif
@@ -0,0 +1,160 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "selection_weights.h"
+
+#include <limits>
+
+using std::vector;
+
+namespace {
+const double INF = std::numeric_limits<double>::infinity();
+
+inline int group(double value) {
+    return (value > 0)? 1 : 0;
+}
+}
+
+SelectionWeights::SelectionWeights(const vector<double> &d, double lambda)
+    : n(d.size()), lambda(lambda), d(d), removed(d.size(), 0), fenwick(d.size() + 1) {
+
+    // Linear time construction: every node pushes its total to its parent
+    for (int i = 1; i <= n; i++) {
+        Node &node = fenwick[i];
+        int g = group(d[i - 1]);
+        node.count[g] += 1;
+        node.sum[g] += d[i - 1];
+        int parent = i + (i & -i);
+        if (parent <= n) {
+            for (int h = 0; h < 2; h++) {
+                fenwick[parent].count[h] += node.count[h];
+                fenwick[parent].sum[h] += node.sum[h];
+            }
+        }
+    }
+
+    size = 1;
+    while (size < n) {
+        size *= 2;
+    }
+    minv.assign(2 * size, INF);
+    maxv.assign(2 * size, -INF);
+    for (int i = 0; i < n; i++) {
+        minv[size + i] = maxv[size + i] = d[i];
+    }
+    for (int node = size - 1; node >= 1; node--) {
+        minv[node] = (minv[2 * node] < minv[2 * node + 1])? minv[2 * node] : minv[2 * node + 1];
+        maxv[node] = (maxv[2 * node] > maxv[2 * node + 1])? maxv[2 * node] : maxv[2 * node + 1];
+    }
+}
+
+void SelectionWeights::add(int i, double delta) {
+    addToGroups(i, d[i], -1);
+    d[i] += delta;
+    addToGroups(i, d[i], 1);
+    updateRange(i);
+}
+
+void SelectionWeights::remove(int i) {
+    addToGroups(i, d[i], -1);
+    removed[i] = 1;
+    updateRange(i);
+}
+
+int SelectionWeights::sample(double u) const {
+    double dmin = minv[1], dmax = maxv[1];
+    if (dmin == INF) {
+        return -1;
+    }
+
+    // Weight of a variable with estimate v in group g is a[g] + b[g] * v
+    double a[2], b[2];
+    if (dmin == dmax) {
+        a[0] = a[1] = 1;
+        b[0] = b[1] = 0;
+    }
+    else {
+        a[0] = (dmin < 0)? 1 : 0;
+        b[0] = (dmin < 0)? -1 / dmin : 0;
+        a[1] = 1;
+        b[1] = (dmax > 0)? lambda / dmax : 0;
+    }
+    auto weight = [&](const Node &node) {
+        return a[0] * node.count[0] + b[0] * node.sum[0] + a[1] * node.count[1] + b[1] * node.sum[1];
+    };
+
+    double total = 0;
+    for (int i = n; i > 0; i -= i & -i) {
+        total += weight(fenwick[i]);
+    }
+    double target = u * total;
+    if (!(total > 0) || !(target > 0)) {
+        return firstUnselected();
+    }
+
+    // Find the last position whose prefix weight is below target
+    int pos = 0;
+    int step = 1;
+    while (2 * step <= n) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n) {
+            double w = weight(fenwick[pos + step]);
+            if (w < target) {
+                pos += step;
+                target -= w;
+            }
+        }
+    }
+
+    // Only rounding can take the search past the last variable or onto a
+    // selected one; step back to the closest unselected variable then
+    if (pos >= n) {
+        pos = n - 1;
+    }
+    while (pos > 0 && removed[pos]) {
+        pos--;
+    }
+    return removed[pos]? firstUnselected() : pos;
+}
+
+void SelectionWeights::addToGroups(int i, double value, double sign) {
+    int g = group(value);
+    for (int k = i + 1; k <= n; k += k & -k) {
+        fenwick[k].count[g] += sign;
+        fenwick[k].sum[g] += sign * value;
+    }
+}
+
+void SelectionWeights::updateRange(int i) {
+    int node = size + i;
+    minv[node] = removed[i]? INF : d[i];
+    maxv[node] = removed[i]? -INF : d[i];
+    for (node /= 2; node >= 1; node /= 2) {
+        minv[node] = (minv[2 * node] < minv[2 * node + 1])? minv[2 * node] : minv[2 * node + 1];
+        maxv[node] = (maxv[2 * node] > maxv[2 * node + 1])? maxv[2 * node] : maxv[2 * node + 1];
+    }
+}
+
+int SelectionWeights::firstUnselected() const {
+    int node = 1;
+    if (minv[node] == INF) {
+        return -1;
+    }
+    while (node < size) {
+        node = (minv[2 * node] != INF)? 2 * node : 2 * node + 1;
+    }
+    return node - size;
+}
@@ -0,0 +1,87 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef _SELECTION_WEIGHTS_H_
+
+#define _SELECTION_WEIGHTS_H_
+
+#include <vector>
+
+/**
+ * Weighted sampling of the variables to perturb in a restart (refer paper for
+ * multi start tabu search by Palubeckis). Every unselected variable i has an
+ * estimate d[i] and is drawn with probability proportional to
+ *     1 - d[i] / dmin             if d[i] <= 0 and dmin < 0
+ *     0                           if d[i] == dmin == 0
+ *     1 + lambda * d[i] / dmax    otherwise
+ * or uniformly if dmin == dmax, where dmin and dmax range over the unselected
+ * variables. Both weights are linear in d[i] within the groups d[i] <= 0 and
+ * d[i] > 0, so Fenwick trees over the count and the sum of d of each group
+ * give every prefix sum of weights in O(log n), and a segment tree keeps dmin
+ * and dmax. Updates and draws take O(log n).
+ */
+class SelectionWeights
+{
+    public:
+        /**
+         * @param d: Initial estimate of every variable, all unselected
+         * @param lambda: Weight of the largest positive estimate
+         */
+        SelectionWeights(const std::vector<double> &d, double lambda);
+
+        /**
+         * Adds to the estimate of an unselected variable
+         * @param i: Variable index
+         * @param delta: Change in d[i]
+         * @return void
+         */
+        void add(int i, double delta);
+
+        /**
+         * Marks a variable selected, excluding it from later draws
+         * @param i: Variable index
+         * @return void
+         */
+        void remove(int i);
+
+        /**
+         * Draws an unselected variable: the first one whose cumulative weight,
+         * in index order, reaches u times the total weight. If all weights are
+         * zero the first unselected variable is drawn.
+         * @param u: Uniform random number in [0, 1)
+         * @return Variable index, -1 if all variables are selected
+         */
+        int sample(double u) const;
+
+    private:
+        struct Node {
+            double count[2];    // Number of unselected variables with d <= 0 and d > 0
+            double sum[2];      // Sums of their estimates
+        };
+
+        void addToGroups(int i, double value, double sign);
+        void updateRange(int i);
+        int firstUnselected() const;
+
+        int n;
+        double lambda;
+        std::vector<double> d;
+        std::vector<char> removed;
+        std::vector<Node> fenwick;      // 1-based Fenwick tree over Node
+        int size;                       // Number of leaves of the segment tree, a power of two
+        std::vector<double> minv;       // Lowest unselected estimate in the subtree
+        std::vector<double> maxv;       // Highest unselected estimate in the subtree
+};
+
+#endif
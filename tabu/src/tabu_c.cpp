@@ -0,0 +1,273 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "tabu_c.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "bqp.h"
+#include "common.h"
+#include "problem_file.h"
+#include "tabu_search.h"
+
+using std::vector;
+
+struct tabu_problem {
+    std::shared_ptr<const BQP<double>> bqp;
+};
+
+struct tabu_cancellation {
+    CancellationToken token;
+};
+
+struct tabu_result {
+    int numReads;
+    int numVariables;
+    vector<std::int8_t> samples;        // numReads x numVariables
+    vector<double> energies;
+    vector<int> restarts;
+    vector<unsigned long long> iterations;
+    vector<unsigned long long> evaluations;
+};
+
+namespace {
+
+tabu_status fail(tabu_error *error, tabu_status status, const char *message) {
+    if (error != nullptr) {
+        snprintf(error->message, sizeof(error->message), "%s", message);
+    }
+    return status;
+}
+
+// Runs f, turning the exceptions of the library into a status and message
+template <class F>
+tabu_status guard(tabu_error *error, tabu_status failure, F f) {
+    try {
+        f();
+    }
+    catch (const Exception &e) {
+        return fail(error, failure, e.what());
+    }
+    catch (const std::bad_alloc &) {
+        return fail(error, TABU_ERROR_OUT_OF_MEMORY, "out of memory");
+    }
+    catch (const std::exception &e) {
+        return fail(error, TABU_ERROR_INTERNAL, e.what());
+    }
+    catch (...) {
+        return fail(error, TABU_ERROR_INTERNAL, "unknown error");
+    }
+    if (error != nullptr) {
+        error->message[0] = '\0';
+    }
+    return TABU_OK;
+}
+
+}
+
+void tabu_options_init_size(tabu_options *options, size_t struct_size) {
+    tabu_options defaults;
+    defaults.struct_size = sizeof(tabu_options);
+    defaults.num_reads = 1;
+    defaults.tenure = 0;
+    defaults.timeout = 20;
+    defaults.num_restarts = 1000000;
+    defaults.use_energy_threshold = 0;
+    defaults.energy_threshold = 0;
+    defaults.num_workers = 1;
+    defaults.num_threads = 1;
+    defaults.max_evaluations = -1;
+    defaults.seed = 0;
+    defaults.initial_states = nullptr;
+    defaults.cancellation = nullptr;
+    defaults.total_timeout = -1;
+    defaults.stop_all_on_threshold = 0;
+
+    // A caller built against an older header has room only for the options it knows
+    std::memcpy(options, &defaults, std::min(struct_size, sizeof(tabu_options)));
+    options->struct_size = struct_size;
+}
+
+tabu_status tabu_problem_create_dense(const double *Q, int num_variables, tabu_problem **problem,
+                                      tabu_error *error) {
+    if (problem == nullptr || num_variables < 0 || (Q == nullptr && num_variables > 0)) {
+        return fail(error, TABU_ERROR_INVALID_ARGUMENT, "invalid argument");
+    }
+    return guard(error, TABU_ERROR_INVALID_ARGUMENT, [&]() {
+        std::unique_ptr<tabu_problem> created(new tabu_problem);
+        created->bqp = std::make_shared<const BQP<double>>(Q, num_variables, num_variables, num_variables, 1);
+        *problem = created.release();
+    });
+}
+
+tabu_status tabu_problem_create_sparse(int num_variables, const double *linear, size_t num_couplings,
+                                       const int *irow, const int *icol, const double *values,
+                                       tabu_problem **problem, tabu_error *error) {
+    if (problem == nullptr || num_variables < 0 || (linear == nullptr && num_variables > 0) ||
+            ((irow == nullptr || icol == nullptr || values == nullptr) && num_couplings > 0)) {
+        return fail(error, TABU_ERROR_INVALID_ARGUMENT, "invalid argument");
+    }
+    return guard(error, TABU_ERROR_INVALID_ARGUMENT, [&]() {
+        std::unique_ptr<tabu_problem> created(new tabu_problem);
+        created->bqp = std::make_shared<const BQP<double>>(num_variables, linear, num_couplings, irow, icol,
+                                                           values);
+        *problem = created.release();
+    });
+}
+
+tabu_status tabu_problem_load(const char *path, tabu_problem **problem, tabu_error *error) {
+    if (problem == nullptr || path == nullptr) {
+        return fail(error, TABU_ERROR_INVALID_ARGUMENT, "invalid argument");
+    }
+    return guard(error, TABU_ERROR_IO, [&]() {
+        std::unique_ptr<tabu_problem> created(new tabu_problem);
+        created->bqp = std::make_shared<const BQP<double>>(std::make_shared<const ProblemFile>(path));
+        *problem = created.release();
+    });
+}
+
+int tabu_problem_num_variables(const tabu_problem *problem) {
+    return problem->bqp->nVars;
+}
+
+void tabu_problem_free(tabu_problem *problem) {
+    delete problem;
+}
+
+tabu_status tabu_solve(const tabu_problem *problem, const tabu_options *options, tabu_result **result,
+                       tabu_error *error) {
+    // Options past the caller's struct_size keep their defaults
+    tabu_options given;
+    tabu_options_init(&given);
+    if (options != nullptr) {
+        if (options->struct_size < offsetof(tabu_options, num_reads)) {
+            return fail(error, TABU_ERROR_INVALID_ARGUMENT, "invalid options struct_size");
+        }
+        std::memcpy(&given, options, std::min(options->struct_size, sizeof(tabu_options)));
+    }
+    options = &given;
+    if (problem == nullptr || result == nullptr || options->num_reads < 0 || options->num_workers < 1 ||
+            options->num_threads < 0) {
+        return fail(error, TABU_ERROR_INVALID_ARGUMENT, "invalid argument");
+    }
+
+    return guard(error, TABU_ERROR_INVALID_ARGUMENT, [&]() {
+        int numReads = options->num_reads;
+        int n = problem->bqp->nVars;
+        std::unique_ptr<tabu_result> solved(new tabu_result);
+        solved->numReads = numReads;
+        solved->numVariables = n;
+        solved->samples.assign((size_t)numReads * n, 0);
+        solved->energies.assign(numReads, 0);
+        solved->restarts.assign(numReads, 0);
+        solved->iterations.assign(numReads, 0);
+        solved->evaluations.assign(numReads, 0);
+
+        if (numReads > 0 && n > 0) {
+            // Starting states, unless given, and read seeds come from one generator per call
+            std::mt19937 generator(options->seed);
+            vector<std::int8_t> initStates((size_t)numReads * n);
+            for (size_t k = 0; k < initStates.size(); k++) {
+                initStates[k] = (options->initial_states != nullptr)? options->initial_states[k] != 0
+                                                                    : generator() & 1;
+            }
+            vector<unsigned int> seeds(numReads);
+            for (int read = 0; read < numReads; read++) {
+                seeds[read] = generator();
+            }
+
+            size_t nWords = (n + 63) / 64;
+            vector<std::uint64_t> packed((size_t)numReads * nWords);
+            double threshold = options->use_energy_threshold? options->energy_threshold
+                                                             : -std::numeric_limits<double>::max();
+            BatchOptions batch;
+            batch.tenure = options->tenure;
+            batch.timeout = options->timeout;
+            batch.numRestarts = options->num_restarts;
+            batch.energyThreshold = threshold;
+            batch.numWorkers = options->num_workers;
+            batch.maxEvaluations = options->max_evaluations;
+            batch.numThreads = options->num_threads;
+            batch.cancellation = (options->cancellation != nullptr)? &options->cancellation->token : nullptr;
+            batch.totalTimeout = options->total_timeout;
+            batch.stopAllOnThreshold = options->stop_all_on_threshold != 0;
+
+            BatchOutputs outputs;
+            outputs.samples = packed.data();
+            outputs.energies = solved->energies.data();
+            outputs.restarts = solved->restarts.data();
+            outputs.iterations = solved->iterations.data();
+            outputs.evaluations = solved->evaluations.data();
+            tabuSearchBatch<double>(problem->bqp, numReads, initStates.data(), seeds.data(), batch, outputs);
+
+            for (int read = 0; read < numReads; read++) {
+                for (int i = 0; i < n; i++) {
+                    solved->samples[(size_t)read * n + i] = (packed[read * nWords + i / 64] >> (i % 64)) & 1;
+                }
+            }
+        }
+        *result = solved.release();
+    });
+}
+
+tabu_cancellation *tabu_cancellation_create(void) {
+    return new (std::nothrow) tabu_cancellation;
+}
+
+void tabu_cancellation_cancel(tabu_cancellation *cancellation) {
+    cancellation->token.cancel();
+}
+
+void tabu_cancellation_free(tabu_cancellation *cancellation) {
+    delete cancellation;
+}
+
+int tabu_result_num_reads(const tabu_result *result) {
+    return result->numReads;
+}
+
+int tabu_result_num_variables(const tabu_result *result) {
+    return result->numVariables;
+}
+
+const int8_t *tabu_result_sample(const tabu_result *result, int read) {
+    return result->samples.data() + (size_t)read * result->numVariables;
+}
+
+double tabu_result_energy(const tabu_result *result, int read) {
+    return result->energies[read];
+}
+
+int tabu_result_num_restarts(const tabu_result *result, int read) {
+    return result->restarts[read];
+}
+
+unsigned long long tabu_result_num_iterations(const tabu_result *result, int read) {
+    return result->iterations[read];
+}
+
+unsigned long long tabu_result_num_evaluations(const tabu_result *result, int read) {
+    return result->evaluations[read];
+}
+
+void tabu_result_free(tabu_result *result) {
+    delete result;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2022 D-Wave Systems Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TABU_C_H_
+
+#define _TABU_C_H_
+
+/*
+ * C interface of the tabu search, for programs without Python or a C++
+ * ABI in common with the library.
+ *
+ * A problem is created once, from a dense or sparse QUBO or a problem file,
+ * and solved any number of times with a set of options, each solve giving
+ * a result to read and free. Problems are immutable, so one problem can be
+ * solved from many threads at once. The library keeps no global state: all
+ * state lives in the objects below, and errors are reported through a
+ * status and an optional tabu_error owned by the caller.
+ *
+ * A solve can be stopped early from another thread through a
+ * tabu_cancellation given in its options.
+ *
+ * tabu_options is allocated by the caller and starts with its own size,
+ * set by tabu_options_init from the header the caller was built with.
+ * New options are only ever appended, past the end of every earlier
+ * version of the struct, and the library reads only the options that fit
+ * in the size given, keeping the defaults for the rest; so a program built
+ * against an older header keeps working with a newer library.
+ *
+ * Coefficients are double; the search runs in double precision.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TABU_OK = 0,
+    TABU_ERROR_INVALID_ARGUMENT,        /* A NULL pointer or an invalid problem or option */
+    TABU_ERROR_IO,                      /* A problem file could not be read */
+    TABU_ERROR_OUT_OF_MEMORY,
+    TABU_ERROR_INTERNAL
+} tabu_status;
+
+/* Message of a failed call, always NUL terminated */
+typedef struct {
+    char message[256];
+} tabu_error;
+
+typedef struct tabu_problem tabu_problem;
+typedef struct tabu_result tabu_result;
+typedef struct tabu_cancellation tabu_cancellation;
+
+typedef struct {
+    size_t struct_size;                 /* sizeof(tabu_options), set by tabu_options_init */
+    int num_reads;                      /* Number of independent reads, default 1 */
+    int tenure;                         /* Tabu tenure, 0 for min(20, num_variables / 4) */
+    long timeout;                       /* Time per read in ms, negative for no limit, default 20 */
+    int num_restarts;                   /* Restarts per read, default 1000000 */
+    int use_energy_threshold;           /* Nonzero to stop a read below energy_threshold */
+    double energy_threshold;
+    int num_workers;                    /* Threads cooperating on each read, default 1 */
+    int num_threads;                    /* Reads run at once, 0 for one per core, default 1 */
+    long long max_evaluations;          /* Moves evaluated per read, negative for no limit */
+    uint32_t seed;                      /* Seed of the starting states and of every read */
+    const int8_t *initial_states;       /* num_reads x num_variables 0/1 values, or NULL for random */
+    tabu_cancellation *cancellation;    /* Stops all reads once cancelled, or NULL */
+    long total_timeout;                 /* Time of all reads in ms, negative for no limit, default -1 */
+    int stop_all_on_threshold;          /* Nonzero to stop all reads once one is below energy_threshold */
+} tabu_options;
+
+/**
+ * Sets the options fitting in struct_size bytes to their defaults, and
+ * options->struct_size to struct_size; called through tabu_options_init
+ * @param options: Options to initialize
+ * @param struct_size: Size of the caller's tabu_options
+ */
+void tabu_options_init_size(tabu_options *options, size_t struct_size);
+
+/* Sets options to their defaults */
+#define tabu_options_init(options) tabu_options_init_size((options), sizeof(tabu_options))
+
+/**
+ * Creates a problem from a dense symmetric QUBO matrix, minimizing x^T Q x
+ * @param Q: num_variables x num_variables matrix, row-major
+ * @param num_variables: Number of variables
+ * @param problem: Output problem, to free with tabu_problem_free
+ * @param error: Output message on failure, or NULL
+ * @return Status
+ */
+tabu_status tabu_problem_create_dense(const double *Q, int num_variables, tabu_problem **problem,
+                                      tabu_error *error);
+
+/**
+ * Creates a problem from linear biases and a list of couplings, as in a
+ * binary quadratic model; couplings given more than once are summed
+ * @param num_variables: Number of variables
+ * @param linear: Linear bias of every variable
+ * @param num_couplings: Number of couplings
+ * @param irow: First variable of every coupling
+ * @param icol: Second variable of every coupling
+ * @param values: Quadratic bias of every coupling
+ * @param problem: Output problem, to free with tabu_problem_free
+ * @param error: Output message on failure, or NULL
+ * @return Status
+ */
+tabu_status tabu_problem_create_sparse(int num_variables, const double *linear, size_t num_couplings,
+                                       const int *irow, const int *icol, const double *values,
+                                       tabu_problem **problem, tabu_error *error);
+
+/**
+ * Maps a problem file with double coefficients (see problem_file.h)
+ * @param path: Path of the file
+ * @param problem: Output problem, to free with tabu_problem_free
+ * @param error: Output message on failure, or NULL
+ * @return Status
+ */
+tabu_status tabu_problem_load(const char *path, tabu_problem **problem, tabu_error *error);
+
+/**
+ * Gets the number of variables of a problem
+ * @param problem: Problem
+ * @return Number of variables
+ */
+int tabu_problem_num_variables(const tabu_problem *problem);
+
+/**
+ * Frees a problem. Results of solving it stay valid.
+ * @param problem: Problem, or NULL
+ */
+void tabu_problem_free(tabu_problem *problem);
+
+/**
+ * Runs options->num_reads tabu searches on a problem
+ * @param problem: Problem
+ * @param options: Options set up by tabu_options_init, or NULL for the defaults
+ * @param result: Output result, to free with tabu_result_free
+ * @param error: Output message on failure, or NULL
+ * @return Status
+ */
+tabu_status tabu_solve(const tabu_problem *problem, const tabu_options *options, tabu_result **result,
+                       tabu_error *error);
+
+/**
+ * Creates a cancellation token, to stop the solves given it in their options
+ * @return Token, to free with tabu_cancellation_free, or NULL if out of memory
+ */
+tabu_cancellation *tabu_cancellation_create(void);
+
+/**
+ * Cancels a token: the solves given it, running or later, stop within one
+ * tabu iteration and return the best solutions found so far. May be called
+ * from any thread, for instance a signal handler's.
+ * @param cancellation: Token
+ */
+void tabu_cancellation_cancel(tabu_cancellation *cancellation);
+
+/**
+ * Frees a token, once no solve is using it
+ * @param cancellation: Token, or NULL
+ */
+void tabu_cancellation_free(tabu_cancellation *cancellation);
+
+/**
+ * Gets the number of reads of a result
+ * @param result: Result
+ * @return Number of reads
+ */
+int tabu_result_num_reads(const tabu_result *result);
+
+/**
+ * Gets the number of variables of a result
+ * @param result: Result
+ * @return Number of variables
+ */
+int tabu_result_num_variables(const tabu_result *result);
+
+/**
+ * Gets the best solution of a read
+ * @param result: Result
+ * @param read: Read, from 0
+ * @return num_variables 0/1 values, valid until the result is freed
+ */
+const int8_t *tabu_result_sample(const tabu_result *result, int read);
+
+/**
+ * Gets the energy of the best solution of a read
+ * @param result: Result
+ * @param read: Read, from 0
+ * @return Energy
+ */
+double tabu_result_energy(const tabu_result *result, int read);
+
+/**
+ * Gets the number of restarts of a read
+ * @param result: Result
+ * @param read: Read, from 0
+ * @return Number of restarts
+ */
+int tabu_result_num_restarts(const tabu_result *result, int read);
+
+/**
+ * Gets the number of tabu search iterations of a read
+ * @param result: Result
+ * @param read: Read, from 0
+ * @return Number of iterations
+ */
+unsigned long long tabu_result_num_iterations(const tabu_result *result, int read);
+
+/**
+ * Gets the number of moves evaluated by a read
+ * @param result: Result
+ * @param read: Read, from 0
+ * @return Number of evaluated moves
+ */
+unsigned long long tabu_result_num_evaluations(const tabu_result *result, int read);
+
+/**
+ * Frees a result
+ * @param result: Result, or NULL
+ */
+void tabu_result_free(tabu_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
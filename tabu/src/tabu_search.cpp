@@ -14,24 +14,158 @@
 
 #include "tabu_search.h"
 
+#include <algorithm>
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 #include "common.h"
+#include "kernels.h"
+#include "move_tree.h"
+#include "selection_weights.h"
 #include "utils.h"
 
 using std::vector;
 using std::size_t;
 
-TabuSearch::TabuSearch(vector<vector<double>> Q, 
-                       const vector<int> initSol, 
-                       int tenure, 
-                       long int timeout,
-                       int numRestarts,
-                       unsigned int seed,
-                       double energyThreshold) 
-    : bqp(Q) {
-    
-    size_t nvars = Q.size();
+/**
+ * Passes the progress of a search, with the statistics of all its workers, to
+ * a bqpSolver_Callback when the best energy improves, at most once every
+ * interval milliseconds. Calls are made under a mutex, so the callback never
+ * runs concurrently for one search.
+ */
+class ProgressReporter {
+    public:
+        ProgressReporter(const bqpSolver_Callback *callback, long long interval, int numWorkers)
+            : callback(callback),
+              interval(interval),
+              startTime(realtime_clock()),
+              lastCall(startTime - interval),
+              workers(numWorkers),
+              bestEnergy(std::numeric_limits<double>::infinity()),
+              reportedEnergy(bestEnergy),
+              stop(false) {}
+
+        /**
+         * Records the state of a worker, and calls the callback if an
+         * improvement is due to be reported
+         */
+        void update(int worker, const SearchState &state) {
+            std::lock_guard<std::mutex> lock(mutex);
+            workers[worker] = state;
+            bestEnergy = std::min(bestEnergy, state.solutionQuality);
+            if (bestEnergy < reportedEnergy && !stop) {
+                long long now = realtime_clock();
+                if (now - lastCall >= interval) {
+                    call(now);
+                }
+            }
+        }
+
+        /**
+         * Reports the final state of the search, whose statistics already
+         * include those of its workers
+         */
+        void finish(const SearchState &state) {
+            std::lock_guard<std::mutex> lock(mutex);
+            workers.assign(1, state);
+            bestEnergy = std::min(bestEnergy, state.solutionQuality);
+            if (!stop) {
+                call(realtime_clock());
+            }
+        }
+
+        /**
+         * Tells whether the callback asked to stop the search
+         */
+        bool stopped() const { return stop; }
+
+    private:
+        void call(long long now) {
+            SearchProgress progress{bestEnergy, 0, 0, 0, (now - startTime) / 1000.0, 0};
+            for (const Counters &counters : workers) {
+                progress.restarts += counters.restarts;
+                progress.iterations += counters.iterations;
+                progress.evaluations += counters.evaluations;
+            }
+            lastCall = now;
+            reportedEnergy = bestEnergy;
+            stop = callback->func(callback, &progress) != 0;
+        }
+
+        struct Counters {
+            unsigned long long restarts = 0;
+            unsigned long long iterations = 0;
+            unsigned long long evaluations = 0;
+
+            Counters() {}
+            Counters(const SearchState &state)
+                : restarts(state.restartNum), iterations(state.iterNum), evaluations(state.evalNum) {}
+        };
+
+        const bqpSolver_Callback *callback;
+        long long interval;
+        long long startTime;
+        long long lastCall;
+        std::mutex mutex;
+        vector<Counters> workers;
+        double bestEnergy;
+        double reportedEnergy;
+        std::atomic<bool> stop;
+};
+
+template <class T>
+TabuSearch<T>::TabuSearch(const vector<vector<double>> &Q, 
+                          const vector<int> &initSol, 
+                          int tenure, 
+                          long int timeout,
+                          int numRestarts,
+                          unsigned int seed,
+                          double energyThreshold,
+                          int numWorkers,
+                          long long maxEvaluations) 
+    : TabuSearch(std::make_shared<const BQP<T>>(Q), initSol, tenure, timeout, numRestarts, seed, energyThreshold, numWorkers,
+                 maxEvaluations) {}
+
+template <class T>
+TabuSearch<T>::TabuSearch(std::shared_ptr<const BQP<T>> problem,
+                          const vector<int> &initSol, 
+                          int tenure, 
+                          long int timeout,
+                          int numRestarts,
+                          unsigned int seed,
+                          double energyThreshold,
+                          int numWorkers,
+                          long long maxEvaluations,
+                          const bqpSolver_Callback *callback,
+                          long long callbackInterval,
+                          const CancellationToken *cancellation) 
+    : TabuSearch(problem, initSol, tenure, seed) {
+
+    run(timeout, numRestarts, energyThreshold, numWorkers, maxEvaluations, callback, callbackInterval,
+        cancellation);
+}
+
+template <class T>
+TabuSearch<T>::TabuSearch(std::shared_ptr<const BQP<T>> problem,
+                          const vector<int> &initSol,
+                          int tenure,
+                          unsigned int seed)
+    : bqp(problem),
+      generator(seed),
+      maxEvaluations(-1),
+      runStartEvaluations(0),
+      started(false),
+      stopFlag(nullptr),
+      cancellation(nullptr),
+      pathRelinking(false),
+      maxRevisits(-1),
+      perturbScale(1),
+      solutionHash(0),
+      worker(0) {
+
+    size_t nvars = bqp->nVars;
     if (initSol.size() != nvars)
         throw Exception("length of init_solution doesn't match the size of Q");
 
@@ -42,367 +176,772 @@ TabuSearch::TabuSearch(vector<vector<double>> Q,
         tabooTenure = tenure;
     }
     else {
-        tabooTenure = (20 < (int)(bqp.nVars / 4.0))? 20 : (int)(bqp.nVars / 4.0);
+        tabooTenure = (20 < (int)(bqp->nVars / 4.0))? 20 : (int)(bqp->nVars / 4.0);
+    }
+
+    state.solution = BitVector(initSol);
+    state.solutionQuality = bqp->getObjective(state.solution);
+}
+
+template <class T>
+TabuSearch<T>::TabuSearch(std::shared_ptr<const BQP<T>> problem, int tenure, unsigned int seed)
+    : bqp(problem),
+      tabooTenure(tenure),
+      generator(seed),
+      maxEvaluations(-1),
+      runStartEvaluations(0),
+      started(true),
+      stopFlag(nullptr),
+      cancellation(nullptr),
+      pathRelinking(false),
+      maxRevisits(-1),
+      perturbScale(1),
+      solutionHash(0),
+      worker(0) {}
+
+template <class T>
+void TabuSearch<T>::run(long int timeout,
+                        int numRestarts,
+                        double energyThreshold,
+                        int numWorkers,
+                        long long maxEvaluations,
+                        const bqpSolver_Callback *callback,
+                        long long callbackInterval,
+                        const CancellationToken *cancellation) {
+
+    if (numWorkers < 1) {
+        throw Exception("number of workers must be positive");
+    }
+
+    this->maxEvaluations = maxEvaluations;
+    this->cancellation = cancellation;
+    runStartEvaluations = state.evalNum;
+
+    // Solve and update state
+    std::unique_ptr<ProgressReporter> progress(
+        (callback != nullptr)? new ProgressReporter(callback, callbackInterval, numWorkers) : nullptr);
+    multiStartTabuSearch(timeout, numRestarts, energyThreshold, numWorkers, progress.get());
+    if (progress) {
+        progress->finish(state);
     }
+    this->cancellation = nullptr;
+}
 
-    generator.seed(seed);
+template <class T>
+void TabuSearch<T>::setElitePool(int size, bool pathRelinking) {
+    elites = ElitePool(size, std::max(1, bqp->nVars / 100));
+    this->pathRelinking = pathRelinking;
+}
 
-    // Solve and update bqp
-    multiStartTabuSearch(timeout, numRestarts, energyThreshold, initSol, nullptr);
+template <class T>
+void TabuSearch<T>::setVisitedMinima(int capacity, int maxRevisits) {
+    visitedMinima = VisitedSet(capacity);
+    zobrist = ZobristKeys((capacity > 0)? bqp->nVars : 0);
+    this->maxRevisits = maxRevisits;
+    perturbScale = 1;
 }
 
-double TabuSearch::bestEnergy()
+template <class T>
+const ElitePool &TabuSearch<T>::elitePool()
 {
-    return bqp.getObjective(bqp.solution);
+    return elites;
 }
 
-vector<int> TabuSearch::bestSolution()
+template <class T>
+double TabuSearch<T>::bestEnergy()
 {
-    return bqp.solution;
+    return bqp->getObjective(state.solution);
 }
 
-int TabuSearch::numRestarts()
+template <class T>
+const BitVector &TabuSearch<T>::bestSolution()
 {
-    return bqp.restartNum;
+    return state.solution;
 }
 
-void TabuSearch::multiStartTabuSearch(long long timeLimitInMilliSecs, 
-                                      int numRestarts, 
-                                      double energyThreshold,
-                                      const vector<int> &initSolution, 
-                                      const bqpSolver_Callback *callback) {
+template <class T>
+int TabuSearch<T>::numRestarts()
+{
+    return state.restartNum;
+}
+
+template <class T>
+unsigned long long TabuSearch<T>::numIterations()
+{
+    return state.iterNum;
+}
+
+template <class T>
+unsigned long long TabuSearch<T>::numEvaluations()
+{
+    return state.evalNum;
+}
+
+template <class T>
+unsigned long long TabuSearch<T>::numMinima()
+{
+    return state.minimaNum;
+}
+
+template <class T>
+unsigned long long TabuSearch<T>::numRevisits()
+{
+    return state.revisitNum;
+}
+
+template <class T>
+unsigned long long TabuSearch<T>::numRevisitStops()
+{
+    return state.revisitStopNum;
+}
+
+template <class T>
+PhaseTimes TabuSearch<T>::phaseTimes()
+{
+    PhaseTimes times = state.phases;
+    times.add(bqp->phases);
+    return times;
+}
+
+/**
+ * Best solution found by the workers of a cooperative multistart search.
+ * energy is read and raced for without locking; the solution itself is
+ * only copied, under mutex, when it improves.
+ */
+struct SharedBest {
+    std::atomic<double> energy;
+    std::mutex mutex;
+    BitVector solution;
+    double solutionEnergy;              // Energy of solution, may trail energy while it is being published
+    std::atomic<long long> restartsLeft;
+    std::atomic<bool> stop;
+
+    SharedBest(const BitVector &initSolution, double initEnergy, long long numRestarts)
+        : energy(initEnergy),
+          solution(initSolution),
+          solutionEnergy(initEnergy),
+          restartsLeft(numRestarts),
+          stop(false) {}
+
+    /**
+     * Publishes a solution if it is better than the best one
+     */
+    void publish(const BitVector &candidate, double candidateEnergy) {
+        double current = energy.load();
+        while (candidateEnergy < current) {
+            if (energy.compare_exchange_weak(current, candidateEnergy)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (candidateEnergy < solutionEnergy) {
+                    solution = candidate;
+                    solutionEnergy = candidateEnergy;
+                }
+                return;
+            }
+        }
+    }
+
+    /**
+     * Replaces a solution by the best one if the best one is better
+     */
+    void fetch(BitVector &target, double &targetEnergy) {
+        if (energy.load() >= targetEnergy) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (solutionEnergy < targetEnergy) {
+            target = solution;
+            targetEnergy = solutionEnergy;
+        }
+    }
+};
+
+template <class T>
+void TabuSearch<T>::multiStartTabuSearch(long long timeLimitInMilliSecs, 
+                                         int numRestarts, 
+                                         double energyThreshold,
+                                         int numWorkers,
+                                         ProgressReporter *progress) {
 
     long long startTime = realtime_clock();
 
-    vector<int> I(bqp.nVars); // will store set of variables to apply steepest ascent to
+    vector<int> I(bqp->nVars); // will store set of variables to apply steepest ascent to
 
     // Z coeffs are used to define the max number of iterations for each individual tabu search
-    int Z1Coeff = (bqp.nVars <= 500)? 10000 : 25000;
-    int Z2Coeff = (bqp.nVars <= 500)? 2500 : 10000;
-
-    bqp.initialize(initSolution);
+    int Z1Coeff = (bqp->nVars <= 500)? 10000 : 25000;
+    int Z2Coeff = (bqp->nVars <= 500)? 2500 : 10000;
 
     bool useTimeLimit = timeLimitInMilliSecs >= 0;
 
-    simpleTabuSearch(bqp.solution, 
-                     bqp.solutionQuality, 
-                     Z1Coeff, 
-                     timeLimitInMilliSecs, 
-                     useTimeLimit, 
-                     energyThreshold, 
-                     callback);
+    if (!started) {
+        state.nIterations = 1;
+        simpleTabuSearch(state.solution, 
+                         state.solutionQuality, 
+                         Z1Coeff, 
+                         timeLimitInMilliSecs, 
+                         useTimeLimit, 
+                         energyThreshold, 
+                         progress);
+        elites.offer(state.solution, state.solutionQuality);
+        started = true;
+    }
+
+    if (numWorkers > 1) {
+        SharedBest shared(state.solution, state.solutionQuality, numRestarts);
 
-    double bestSolutionQuality = bqp.solutionQuality;
-    vector<int> bestSolution(bqp.solution.begin(), bqp.solution.end());
+        // This search is worker 0, the others get seeds drawn from its RNG
+        vector<std::unique_ptr<TabuSearch>> workers;
+        for (int w = 1; w < numWorkers; w++) {
+            workers.emplace_back(new TabuSearch(bqp, tabooTenure, generator()));
+            workers.back()->maxEvaluations = maxEvaluations;
+            workers.back()->cancellation = cancellation;
+            workers.back()->worker = w;
+            workers.back()->setElitePool(elites.capacity(), pathRelinking);
+            workers.back()->setVisitedMinima(visitedMinima.capacity(), maxRevisits);
+            workers.back()->state.solution = state.solution;
+            workers.back()->state.solutionQuality = state.solutionQuality;
+        }
+
+        parallel_for(numWorkers, numWorkers, [&](int w) {
+            TabuSearch &worker = (w == 0)? *this : *workers[w - 1];
+            worker.cooperativeRestarts(shared, startTime, timeLimitInMilliSecs, useTimeLimit, 
+                                       energyThreshold, Z2Coeff, progress);
+        });
+
+        for (auto &worker : workers) {
+            for (int k = 0; k < worker->elites.size(); k++) {
+                elites.offer(worker->elites.solution(k), worker->elites.energy(k));
+            }
+            state.restartNum += worker->state.restartNum;
+            state.iterNum += worker->state.iterNum;
+            state.evalNum += worker->state.evalNum;
+            state.minimaNum += worker->state.minimaNum;
+            state.revisitNum += worker->state.revisitNum;
+            state.revisitStopNum += worker->state.revisitStopNum;
+            state.phases.add(worker->state.phases);
+        }
+        state.solutionQuality = shared.solutionEnergy;
+        state.solution = shared.solution;
+        return;
+    }
 
-    vector<vector<double>> C(bqp.nVars, vector<double>(bqp.nVars));
+    double bestSolutionQuality = state.solutionQuality;
+    BitVector bestSolution = state.solution;
 
     for (long iter = 0; iter < numRestarts; iter++) {
         if ((bestSolutionQuality <= energyThreshold) ||
-            (useTimeLimit && (realtime_clock() - startTime) > timeLimitInMilliSecs)) {
+            (useTimeLimit && (realtime_clock() - startTime) > timeLimitInMilliSecs) ||
+            (progress != nullptr && progress->stopped()) ||
+            cancelled() ||
+            budgetSpent()) {
             break;
         }
 
-        // Compute coefficients from current solution (used later to get solution from steepestAscent())
-        computeC(C, bqp.solution);
+        restart(I);
+
+        // Run taboo search and update solution again
+        state.restartNum++;
+        simpleTabuSearch(state.solution, 
+                         state.solutionQuality, 
+                         Z2Coeff, 
+                         timeLimitInMilliSecs - (realtime_clock() - startTime), 
+                         useTimeLimit, 
+                         energyThreshold, 
+                         progress);
+        elites.offer(state.solution, state.solutionQuality);
+    
+        if (bestSolutionQuality > state.solutionQuality) {
+            bestSolutionQuality = state.solutionQuality;
+            bestSolution = state.solution;
+        }
 
-        // Select a group of variables (I) and apply steepest ascent to it
-        int numSelection = (10 > (int)(ALPHA * bqp.nVars))? 10 : (int)(ALPHA * bqp.nVars);
-        if (numSelection > bqp.nVars) {
-            numSelection = bqp.nVars;
+        if (progress != nullptr) {
+            progress->update(worker, state);
         }
+    }
+    
+    state.solutionQuality = bestSolutionQuality;
+    state.solution = bestSolution;
+}
 
-        selectVariables(numSelection, C, I);  
+template <class T>
+void TabuSearch<T>::cooperativeRestarts(SharedBest &shared,
+                                        long long startTime,
+                                        long long timeLimitInMilliSecs,
+                                        bool useTimeLimit,
+                                        double energyThreshold,
+                                        long long ZCoeff,
+                                        ProgressReporter *progress) {
 
-        // Construct new initial solution to apply taboo search to 
-        vector<int> solution(bqp.nVars);
-        steepestAscent(numSelection, C, I, solution);    
+    vector<int> I(bqp->nVars);
 
-        for (int i = 0; i < numSelection; i++) {
-            if (solution[I[i]] == 1) {
-                bqp.solution[I[i]] = 1 - bqp.solution[I[i]];  // flipping variable
-            }
+    stopFlag = &shared.stop;
+
+    while (!shared.stop && shared.restartsLeft-- > 0) {
+        if ((shared.energy <= energyThreshold) ||
+            (useTimeLimit && (realtime_clock() - startTime) > timeLimitInMilliSecs) ||
+            (progress != nullptr && progress->stopped()) ||
+            cancelled()) {
+            shared.stop = true;
+            break;
+        }
+        if (budgetSpent()) {
+            break;
         }
-        bqp.solutionQuality = bqp.getObjective(bqp.solution);
 
-        // Run taboo search and update solution again
-        bqp.restartNum++;
-        simpleTabuSearch(bqp.solution, 
-                         bqp.solutionQuality, 
-                         Z2Coeff, 
+        shared.fetch(state.solution, state.solutionQuality);
+
+        restart(I);
+
+        state.restartNum++;
+        simpleTabuSearch(state.solution, 
+                         state.solutionQuality, 
+                         ZCoeff, 
                          timeLimitInMilliSecs - (realtime_clock() - startTime), 
                          useTimeLimit, 
                          energyThreshold, 
-                         callback);
-    
-        if (bestSolutionQuality > bqp.solutionQuality) {
-            bestSolutionQuality = bqp.solutionQuality;
-            bestSolution = bqp.solution;
+                         progress);
+        elites.offer(state.solution, state.solutionQuality);
+
+        shared.publish(state.solution, state.solutionQuality);
+
+        if (progress != nullptr) {
+            progress->update(worker, state);
         }
+    }
+
+    if (shared.energy <= energyThreshold) {
+        shared.stop = true;
+    }
+    stopFlag = nullptr;
+}
+
+namespace {
+
+// Entry C[i][j], i != j, of the C matrix for the given solution and coupling of i and j
+inline double offDiagonalC(const BitVector &solution, int i, int j, double coupling) {
+    return (solution[i] == solution[j])? -coupling : coupling;
+}
 
-        if (callback != nullptr) {
-            callback->func(callback, &bqp);
+// Calls f(j, coupling of i and j) for every j != i among the first numSelection
+// entries of I (flagged in isSelected), in the order of I for dense rows
+template <class T, class F>
+void forEachSelectedNeighbor(const BQP<T> &bqp, int i, const vector<int> &I, int numSelection,
+                             const vector<char> &isSelected, F f) {
+    BQPRow<T> row = bqp.row(i);
+    if (bqp.dense) {
+        for (int t = 0; t < numSelection; t++) {
+            if (I[t] != i) {
+                f(I[t], row.value[I[t]]);
+            }
         }
     }
-    
-    bqp.solutionQuality = bestSolutionQuality;
-    bqp.solution = bestSolution;
+    else {
+        for (int p = 0; p < row.size; p++) {
+            if (isSelected[row.index[p]]) {
+                f(row.index[p], row.value[p]);
+            }
+        }
+    }
+}
+
+}
+
+template <class T>
+void TabuSearch<T>::perturb(vector<int> &I) {
+    // Compute the diagonal of C from current solution (used later to get solution from steepestAscent()),
+    // its other entries are read from the couplings when needed
+    vector<double> diagonal(bqp->nVars);
+    computeCDiagonal(diagonal, state.solution);
+
+    // Select a group of variables (I) and apply steepest ascent to it
+    int numSelection = (10 > (int)(ALPHA * bqp->nVars))? 10 : (int)(ALPHA * bqp->nVars);
+    numSelection = (int)std::min((long long)numSelection * perturbScale, (long long)bqp->nVars);
+    if (numSelection > bqp->nVars) {
+        numSelection = bqp->nVars;
+    }
+
+    selectVariables(numSelection, diagonal, I);  
+
+    // Construct new initial solution to apply taboo search to 
+    BitVector solution(bqp->nVars);
+    steepestAscent(numSelection, diagonal, I, solution);    
+
+    for (int i = 0; i < numSelection; i++) {
+        if (solution[I[i]] == 1) {
+            state.solution.flip(I[i]);  // flipping variable
+        }
+    }
+    state.solutionQuality = bqp->getObjective(state.solution);
+}
+
+template <class T>
+void TabuSearch<T>::restart(vector<int> &I) {
+    if (pathRelinking && state.restartNum % 2 == 1 && relink()) {
+        return;
+    }
+    perturb(I);
+}
+
+template <class T>
+bool TabuSearch<T>::relink() {
+    int numElites = elites.size();
+    if (numElites < 2) {
+        return false;
+    }
+    PhaseTimer timer(state.phases, PHASE_PATH_RELINK);
+
+    int from = numElites * (double)generator() / ((double)generator.max() + 1);
+    int to = (numElites - 1) * (double)generator() / ((double)generator.max() + 1);
+    if (to >= from) {
+        to++;
+    }
+    const BitVector &guiding = elites.solution(to);
+    int numDiffer = elites.solution(from).distance(guiding);
+    if (numDiffer < 4) {
+        return false;
+    }
+
+    BitVector solution = elites.solution(from);
+    double energy = elites.energy(from);
+    vector<T> sign(bqp->nVars);
+    vector<T> changeInObjective(bqp->nVars);
+    vector<int> differ;
+    for (int i = 0; i < bqp->nVars; i++) {
+        sign[i] = 1 - 2 * solution[i];
+        changeInObjective[i] = bqp->getChangeInObjective(solution, i);
+        if (solution[i] != guiding[i]) {
+            differ.push_back(i);
+        }
+    }
+
+    // As in simpleTabuSearch, sparse problems select moves from a tree, with
+    // the variables that already agree with the guiding solution masked out
+    std::unique_ptr<MoveTree> tree(bqp->dense? nullptr : new MoveTree(changeInObjective));
+    if (tree) {
+        for (int i = 0; i < bqp->nVars; i++) {
+            if (solution[i] == guiding[i]) {
+                tree->setTaboo(i);
+            }
+        }
+    }
+
+    int first = numDiffer / 4;
+    int last = numDiffer - numDiffer / 4;
+    double bestEnergy = std::numeric_limits<double>::max();
+    for (int step = 1; step <= last; step++) {
+        int k;
+        if (tree) {
+            k = tree->findMin(0);
+            state.evalNum += 1;
+        }
+        else {
+            size_t best = 0;
+            for (size_t p = 1; p < differ.size(); p++) {
+                if (changeInObjective[differ[p]] < changeInObjective[differ[best]]) {
+                    best = p;
+                }
+            }
+            k = differ[best];
+            differ[best] = differ.back();
+            differ.pop_back();
+            state.evalNum += differ.size() + 1;
+        }
+
+        energy += changeInObjective[k];
+        flipVariable(k, solution, sign, changeInObjective, tree.get());
+        if (tree) {
+            tree->setTaboo(k);
+        }
+        if (step >= first && energy < bestEnergy) {
+            bestEnergy = energy;
+            state.solution = solution;
+        }
+    }
+    state.solutionQuality = bqp->getObjective(state.solution);
+    return true;
 }
 
-void TabuSearch::simpleTabuSearch(const vector<int> &starting,
-                                  double startingObjective,
-                                  long long ZCoeff,
-                                  long long timeLimitInMilliSecs,
-                                  bool useTimeLimit,
-                                  double energyThreshold,
-                                  const bqpSolver_Callback *callback) {
+template <class T>
+void TabuSearch<T>::simpleTabuSearch(const BitVector &starting,
+                                     double startingObjective,
+                                     long long ZCoeff,
+                                     long long timeLimitInMilliSecs,
+                                     bool useTimeLimit,
+                                     double energyThreshold,
+                                     ProgressReporter *progress) {
 
+    PhaseTimer initTimer(state.phases, PHASE_INITIALIZE);
     long long startTime = realtime_clock();
-    bqp.solutionQuality = startingObjective;
+    Deadline deadline(startTime + timeLimitInMilliSecs);
+    state.solutionQuality = startingObjective;
 
-    vector<int> taboo(bqp.nVars);  // used to keep track of history of flipped bits
-    vector<int> solution(bqp.nVars);
-    vector<double> changeInObjective(bqp.nVars);
+    // A variable flipped at step t stays taboo up to step t + tabooTenure
+    vector<long long> tabooUntil(bqp->nVars);
+    BitVector solution = starting;
+    vector<T> sign(bqp->nVars);
+    vector<T> changeInObjective(bqp->nVars);
 
-    for (int i = 0; i < bqp.nVars; i++) {
-        taboo[i] = 0;
-        solution[i] = starting[i];
-        bqp.solution[i] = starting[i];
-        changeInObjective[i] = bqp.getChangeInObjective(starting, i);
+    state.solution = starting;
+    for (int i = 0; i < bqp->nVars; i++) {
+        tabooUntil[i] = -1;
+        sign[i] = 1 - 2 * starting[i];
+        changeInObjective[i] = bqp->getChangeInObjective(starting, i);
     }
 
-    double prevCost = bqp.solutionQuality;
+    double prevCost = state.solutionQuality;
     double cost = 0;
 
-    vector<int> tieList(bqp.nVars);
+    vector<int> tieList(bqp->nVars);
+
+    // Sparse problems select moves from a tree, as their flips update only a
+    // few entries; dense ones scan all entries, as every flip updates them all.
+    // Taboo variables are masked out of the tree and put back, in the order
+    // they were flipped, once they expire.
+    std::unique_ptr<MoveTree> tree(bqp->dense? nullptr : new MoveTree(changeInObjective));
+    std::deque<int> expiring;
+
+    // Zobrist hash of solution, whether solution was reached by an improving
+    // move, and the minima reached before since the best solution last improved
+    bool tracking = zobrist.size() > 0;
+    std::uint64_t hash = tracking? zobrist.hash(starting) : 0;
+    bool descending = true;
+    int revisits = 0;
+    bool revisitStop = false;
 
     long long iter = 0;
-    long long maxIter = (500000 > ZCoeff * (long long)bqp.nVars)? 500000 : ZCoeff * (long long)bqp.nVars;
+    long long maxIter = (500000 > ZCoeff * (long long)bqp->nVars)? 500000 : ZCoeff * (long long)bqp->nVars;
 
-    while (iter < maxIter) {
-        if ((bqp.solutionQuality <= energyThreshold) ||
-            (useTimeLimit && (realtime_clock() - startTime) > timeLimitInMilliSecs)) {
+    initTimer.stop();
+    PhaseTimer loopTimer(state.phases, PHASE_TABU_LOOP);
+
+    for (long long step = 0; iter < maxIter; step++) {
+        if ((state.solutionQuality <= energyThreshold) ||
+            (useTimeLimit && deadline.passed()) ||
+            (stopFlag != nullptr && *stopFlag) ||
+            (progress != nullptr && progress->stopped()) ||
+            cancelled() ||
+            budgetSpent()) {
             break;
         }
 
-        bqp.iterNum++; // added to record more statistics
+        state.iterNum++; // added to record more statistics
         double localMinCost = std::numeric_limits<double>::max();
-        int bestK = -1;
-        bool globalMinFound = false;
         int numTies = 0;
-        bqp.evalNum += bqp.nVars; // added to record more statistics
+        state.evalNum += bqp->nVars; // added to record more statistics
 
-        for (int k = 0; k < bqp.nVars; k++) {
-            if (taboo[k] != 0) {
-                // variable at k was not recently flipped
-                continue;
+        // Take the first non-taboo move improving on the best solution, else a
+        // random one of the best non-taboo moves
+        int bestK;
+        if (tree) {
+            while (!expiring.empty() && tabooUntil[expiring.front()] < step) {
+                tree->clearTaboo(expiring.front(), changeInObjective[expiring.front()]);
+                expiring.pop_front();
             }
-            iter++;
-            cost = prevCost + changeInObjective[k];
-            if (cost < bqp.solutionQuality) {
-                globalMinFound = true;
-                bestK = k;
-                break;
+            bestK = tree->firstBelow(prevCost, state.solutionQuality);
+            iter += tree->countAllowed((bestK == -1)? bqp->nVars : bestK + 1);
+            if (bestK == -1 && tree->minCount() > 0) {
+                localMinCost = prevCost + tree->minValue();
+                numTies = tree->minCount();
             }
-            if (cost < localMinCost) {
-                bestK = k;
-                localMinCost = cost;
-                tieList[0] = k;
-                numTies = 1;
+        }
+        else {
+            bestK = scanMoves(bqp->nVars, changeInObjective.data(), tabooUntil.data(), step, prevCost,
+                              state.solutionQuality, localMinCost, iter);
+            if (bestK == -1 && localMinCost != std::numeric_limits<double>::max()) {
+                numTies = collectTies(bqp->nVars, changeInObjective.data(), tabooUntil.data(), step, prevCost,
+                                      localMinCost, tieList.data());
             }
-            else if (cost == localMinCost) {
-                tieList[numTies] = k; numTies++;
+        }
+        bool globalMinFound = (bestK != -1);
+        if (globalMinFound) {
+            cost = prevCost + changeInObjective[bestK];
+        }
+        else if (numTies > 0) {
+            int r = 0;
+            if (numTies > 1) {
+                r = numTies * (double)generator() / ((double)generator.max() + 1);
             }
+            bestK = tree? tree->findMin(r) : tieList[r];
         }
 
-        if (!globalMinFound && numTies > 1) {
-            bestK = numTies * (double)generator() / ((double)generator.max() + 1);
-            bestK = tieList[bestK];
-        }
-        for (int i = 0; i < bqp.nVars; i++) {
-            if (taboo[i] > 0) {
-                taboo[i] = taboo[i] - 1;
+        // A descent ends where no allowed move improves on solution: a local
+        // minimum, as opposed to the next steps of a walk on its plateau
+        if (tracking && descending && !globalMinFound && numTies > 0 && localMinCost >= prevCost) {
+            state.minimaNum++;
+            if (visitedMinima.insert(hash)) {
+                state.revisitNum++;
+                if (maxRevisits >= 0 && ++revisits > maxRevisits) {
+                    state.revisitStopNum++;
+                    revisitStop = true;
+                    break;
+                }
             }
         }
+
         if (bestK == -1) {
             continue;
         }
-        solution[bestK] = 1 - solution[bestK];
+        descending = globalMinFound || localMinCost < prevCost;
         prevCost = localMinCost;
-        for (int i = 0; i < bestK; i++) {
-            double change = bqp.Q[i][bestK];
-            changeInObjective[i] += (solution[i] != solution[bestK])? change : -change; 
+        flipVariable(bestK, solution, sign, changeInObjective, tree.get());
+        if (tracking) {
+            hash ^= zobrist.key(bestK);
         }
-        for (int i = bestK + 1; i < bqp.nVars; i++) {
-            double change = bqp.Q[bestK][i];
-            changeInObjective[i] += (solution[i] != solution[bestK])? change : -change;
+        tabooUntil[bestK] = step + tabooTenure;
+        if (tree) {
+            tree->setTaboo(bestK);
+            expiring.push_back(bestK);
         }
-        changeInObjective[bestK] = -changeInObjective[bestK];
-        taboo[bestK] = tabooTenure;
         if (globalMinFound) {
-            localSearchInternal(solution, cost, changeInObjective);
-            solution = bqp.solution;
-            prevCost = bqp.solutionQuality;
-            iter += bqp.nIterations;
-            bqp.nIterations = iter;
-
-            if (callback != nullptr) {
-                callback->func(callback, &bqp);
+            localSearchInternal(solution, cost, changeInObjective, hash);
+            solution = state.solution;
+            hash = solutionHash;
+            revisits = 0;
+            for (int i = 0; i < bqp->nVars; i++) {
+                sign[i] = 1 - 2 * solution[i];
+            }
+            if (tree) {
+                tree->reset(changeInObjective);
+                for (int i : expiring) {
+                    tree->setTaboo(i);
+                }
             }
+            prevCost = state.solutionQuality;
+            iter += state.nIterations;
+            state.nIterations = iter;
 
-            if (bqp.solutionQuality <= bqp.upperBound) {
-                timeLimitInMilliSecs = 0;
+            if (progress != nullptr) {
+                progress->update(worker, state);
+            }
+
+            // The local search and the progress report take far longer than
+            // an iteration, so the stride the deadline adapted would overshoot
+            deadline.checkNext();
+            if (state.solutionQuality <= state.upperBound) {
+                deadline = Deadline(startTime);
             }
         }
     }
+
+    if (tracking) {
+        perturbScale = revisitStop? std::min(2 * perturbScale, bqp->nVars) : 1;
+    }
 }
 
-void TabuSearch::localSearchInternal(const vector<int> &starting, double startingObjective, vector<double> &changeInObjective) {
-    bqp.solution = starting;
-    bqp.solutionQuality = startingObjective;
+template <class T>
+void TabuSearch<T>::localSearchInternal(const BitVector &starting, double startingObjective, vector<T> &changeInObjective,
+                                        std::uint64_t startingHash) {
+    PhaseTimer timer(state.phases, PHASE_LOCAL_SEARCH);
+
+    state.solution = starting;
+    state.solutionQuality = startingObjective;
+
+    vector<T> sign(bqp->nVars);
+    for (int i = 0; i < bqp->nVars; i++) {
+        sign[i] = 1 - 2 * starting[i];
+    }
 
     long long iter = 0;
     bool improved;
+    bool tracking = zobrist.size() > 0;
+    std::uint64_t hash = startingHash;
 
     do {
         improved = false;
-        for (int i = 0; i < bqp.nVars; i++, iter++) {
-            bqp.evalNum++; /*added to record more statistics.*/
+        for (int i = 0; i < bqp->nVars; i++, iter++) {
+            state.evalNum++; /*added to record more statistics.*/
             if (changeInObjective[i] < 0) {
                 improved = true;
-                bqp.solution[i] = 1 - bqp.solution[i];
-                bqp.solutionQuality = bqp.solutionQuality + changeInObjective[i];
-                changeInObjective[i] = -changeInObjective[i];
-                for (int j = 0; j < bqp.nVars; j++) {
-                    if (j != i) {
-                        double change = bqp.Q[i][j] + bqp.Q[j][i];
-                        changeInObjective[j] += (bqp.solution[j] != bqp.solution[i])? change : -change;
-                    }
+                state.solutionQuality = state.solutionQuality + changeInObjective[i];
+                flipVariable(i, state.solution, sign, changeInObjective);
+                if (tracking) {
+                    hash ^= zobrist.key(i);
                 }
             }
         }
     } while(improved);
 
-    bqp.nIterations = iter;
+    state.nIterations = iter;
+    solutionHash = hash;
 }
 
-void TabuSearch::selectVariables(int numSelection, vector<vector<double>> &C, vector<int> &I) {
-    int i, ctr;
-    vector<double> d(bqp.nVars);   // estimate used to calculate e
-    for (i = 0; i < bqp.nVars; i++) {
-        d[i] = C[i][i];
-    }
-
-    vector<double> e(bqp.nVars);   // used to assign probability of being selected as a free variable  
-    vector<double> prob(bqp.nVars);
-    vector<int> selected(bqp.nVars, 0);   
-    double prevProb, sumE;
+template <class T>
+void TabuSearch<T>::flipVariable(int k, BitVector &solution, vector<T> &sign, vector<T> &changeInObjective,
+                                 MoveTree *tree) {
+    solution.flip(k);
+    sign[k] = -sign[k];
 
-    for (ctr = 0; ctr < numSelection; ctr++) {
-        double dmin = std::numeric_limits<double>::max();
-        double dmax = -std::numeric_limits<double>::max();
-        for (i = 0; i < bqp.nVars; i++) {
-            if (selected[i] == 1) {
-                continue;
-            }
-            if (d[i] > dmax) {
-                dmax = d[i];
-            }
-            if (d[i] < dmin) {
-                dmin = d[i];
-            }
-        }
-        if (dmin == dmax) {
-            for (i = 0; i < bqp.nVars; i++) {
-                if (selected[i] == 1) {
-                    continue;
-                }
-                e[i] = 1;
-            }
-        }
-        else {
-            for (i = 0; i < bqp.nVars; i++) {
-                if(selected[i] == 1) {
-                    continue;
-                }
-                if (d[i] <= 0 && dmin < 0) {
-                    e[i] = 1 - d[i] / dmin;
-                }
-                else if (d[i] == dmin && dmin == 0) {
-                    e[i] = 0;
-                }
-                else {
-                    e[i] = 1 + LAMBDA * (d[i] / dmax);
-                }
-            }
-        }
-        for (i = 0, sumE = 0, prevProb = 0; i < bqp.nVars; i++) {
-            if (selected[i] == 1) {
-                continue;
-            }
-            prob[i] = prevProb + e[i];
-            prevProb = prob[i];
-            sumE = sumE + e[i];
-        }
-        if (sumE == 0) {
-            sumE = 1;
-            for (i = 0; i < bqp.nVars; i++) {
-                if (selected[i] == 0) {
-                    if (prob[i] == 0) {
-                        prob[i] = 1;
-                    }
-                    else {
-                        printf("ERROR: probability is non-zero and yet the sum is zero\n");
-                    }
-                }
+    // A neighbor's change moves by +coupling if it now differs from k, else by
+    // -coupling, i.e. by -sign[k] * sign[j] * coupling
+    BQPRow<T> row = bqp->row(k);
+    if (row.index == nullptr) {
+        addSignedRow(row.size, row.value, sign.data(), -sign[k], changeInObjective.data());
+    }
+    else {
+        for (int p = 0; p < row.size; p++) {
+            int j = row.index[p];
+            changeInObjective[j] += (solution[j] != solution[k])? row.value[p] : -row.value[p];
+            if (tree != nullptr) {
+                tree->update(j, changeInObjective[j]);
             }
         }
+    }
+    changeInObjective[k] = -changeInObjective[k];
+    if (tree != nullptr) {
+        tree->update(k, changeInObjective[k]);
+    }
+}
+
+template <class T>
+void TabuSearch<T>::selectVariables(int numSelection, const vector<double> &diagonal, vector<int> &I) {
+    PhaseTimer timer(state.phases, PHASE_SELECT_VARIABLES);
+
+    // Weights of the unselected variables, from the estimates d used to calculate e (initially the diagonal of C)
+    SelectionWeights weights(diagonal, LAMBDA);
+    vector<int> selected(bqp->nVars, 0);
+
+    for (int ctr = 0; ctr < numSelection; ctr++) {
         double selectedProb = (double)generator() / ((double)generator.max() + 1);
-        int selectedVar = -1;
-        for (int i = 0; i < bqp.nVars; i++) {
-            if (selected[i] == 1) {
-                continue;
-            }
-            if (selectedProb <= prob[i] / sumE) {
-                selectedVar = i;
-                break;
-            }
-        }
-        if (selectedVar < 0 || selectedVar > bqp.nVars - 1) {
+        int selectedVar = weights.sample(selectedProb);
+        if (selectedVar < 0 || selectedVar > bqp->nVars - 1) {
             printf("ERROR!!!\n");
         }
         I[ctr] = selectedVar;
         selected[selectedVar] = 1;
-        for (int i = 0; i < bqp.nVars; i++) {
+        weights.remove(selectedVar);
+        bqp->forEachNeighbor(selectedVar, [&](int i, double coupling) {
             if (selected[i] == 0) {
-                d[i] = d[i] + C[i][selectedVar];    // update d for each unselected variable
+                weights.add(i, offDiagonalC(state.solution, i, selectedVar, coupling));    // update d for each unselected variable
             }
-        }
+        });
     }
 }
 
-void TabuSearch::steepestAscent(int numSelection, vector<vector<double>> &C, vector<int> &I, vector<int> &solution) {
-    int i, j, ctr;
-    int idI, idJ, r, v = 0;
-    vector<double> h1(bqp.nVars);
-    vector<double> h2(bqp.nVars);
-    vector<double> q1(bqp.nVars);
-    vector<double> q2(bqp.nVars);
-    vector<int> visited(bqp.nVars, 0);
+template <class T>
+void TabuSearch<T>::steepestAscent(int numSelection, const vector<double> &diagonal, vector<int> &I, BitVector &solution) {
+    PhaseTimer timer(state.phases, PHASE_STEEPEST_ASCENT);
+
+    int i, j = 0, ctr;
+    int idI, r, v = 0;
+    vector<double> h1(bqp->nVars);
+    vector<double> h2(bqp->nVars);
+    vector<double> q1(bqp->nVars);
+    vector<double> q2(bqp->nVars);
+    vector<int> visited(bqp->nVars, 0);
+    vector<char> isSelected(bqp->nVars, 0);
 
-    std::fill(solution.begin(), solution.end(), 0); // all vars outside of selected variables (I) stay fixed at 0
+    solution.reset(); // all vars outside of selected variables (I) stay fixed at 0
 
+    for (i = 0; i < numSelection; i++) {
+        isSelected[I[i]] = 1;
+    }
     for (i = 0; i < numSelection; i++) {
         idI = I[i];
-        h1[idI] = C[idI][idI];
+        h1[idI] = diagonal[idI];
         h2[idI] = 0;
-        for (j = 0; j < numSelection; j++) {
-            idJ = I[j];
-            if (idJ != idI) {
-                h2[idI] = h2[idI] + (C[idI][idJ]);
-            }
-        }
-        h2[idI] = h2[idI] * 1;
+        forEachSelectedNeighbor(*bqp, idI, I, numSelection, isSelected, [&](int idJ, double coupling) {
+            h2[idI] = h2[idI] + offDiagonalC(state.solution, idI, idJ, coupling);
+        });
     }
 
     for (ctr = 0; ctr < numSelection; ctr++) {
@@ -430,31 +969,218 @@ void TabuSearch::steepestAscent(int numSelection, vector<vector<double>> &C, vec
                 v = r;
             }
         }
-        solution[j] = v;
+        solution.set(j, v);
         visited[j] = 1;
-        for (i = 0; i < numSelection; i++) {
-            idI = I[i];
+        forEachSelectedNeighbor(*bqp, j, I, numSelection, isSelected, [&](int idI, double coupling) {
             if (visited[idI] == 1) {
-                continue;
+                return;
             }
-            h2[idI] = h2[idI] - 1 * (C[idI][j]);
+            double c = offDiagonalC(state.solution, idI, j, coupling);
+            h2[idI] = h2[idI] - c;
             if (v == 1) {
-                h1[idI] = h1[idI] + 1 * (C[idI][j]);
+                h1[idI] = h1[idI] + c;
             }
-        }
+        });
+    }
+}
+
+template <class T>
+void TabuSearch<T>::computeCDiagonal(vector<double> &diagonal, const BitVector &solution) {
+    PhaseTimer timer(state.phases, PHASE_COMPUTE_C);
+
+    for (int i = 0; i < bqp->nVars; i++) {
+        diagonal[i] = -bqp->linearView[i];
+        bqp->forEachNeighbor(i, [&](int j, double coupling) {
+            if (j > i && solution[j] == 1) {
+                diagonal[i] += -coupling;
+            }
+        });
+        diagonal[i] = (solution[i] == 1)? -diagonal[i] : diagonal[i];
     }
 }
 
-void TabuSearch::computeC(vector<vector<double>> &C, const vector<int> &solution) {
-    for (int i = 0; i < bqp.nVars; i++) {
-        C[i][i] = -bqp.Q[i][i];
-        for (int j = i + 1; j < bqp.nVars; j++) {
-            if (solution[j] == 1) {
-                C[i][i] += -(bqp.Q[i][j]);
+namespace {
+
+// Callback of one read of tabuSearchBatch(), forwarding to the batch callback
+// with the read index
+struct ReadCallback {
+    bqpSolver_Callback callback;
+    const bqpSolver_Callback *batch;
+    int read;
+};
+
+int forwardRead(const bqpSolver_Callback *callback, const SearchProgress *progress) {
+    const ReadCallback *self = static_cast<const ReadCallback *>(callback->context);
+    SearchProgress tagged = *progress;
+    tagged.read = self->read;
+    return self->batch->func(self->batch, &tagged);
+}
+
+}
+
+template <class T>
+void tabuSearchBatch(std::shared_ptr<const BQP<T>> problem,
+                     int numReads,
+                     const std::int8_t *initStates,
+                     const unsigned int *seeds,
+                     const BatchOptions &options,
+                     const BatchOutputs &outputs) {
+
+    size_t nVars = problem->nVars;
+    size_t nWords = (nVars + 63) / 64;     // Words of a packed solution
+
+    // Cancelled with the caller's token, or by the first read to meet the threshold
+    CancellationToken batchCancellation(options.cancellation);
+    long long startTime = realtime_clock();
+
+    std::mutex phasesMutex;
+    if (outputs.phases != nullptr) {
+        *outputs.phases = problem->phases;
+    }
+
+    int numThreads = options.numThreads;
+    if (options.numWorkers > 1) {
+        int hardwareThreads = std::thread::hardware_concurrency();
+        if (numThreads <= 0) {
+            numThreads = hardwareThreads;
+        }
+        numThreads = std::max(1, std::min(numThreads, hardwareThreads / options.numWorkers));
+    }
+
+    parallel_for(numReads, numThreads, [&](int read) {
+        vector<int> initSol(initStates + read * nVars, initStates + (read + 1) * nVars);
+
+        ReadCallback readCallback;
+        readCallback.callback.func = forwardRead;
+        readCallback.callback.context = &readCallback;
+        readCallback.batch = options.callback;
+        readCallback.read = read;
+
+        long int timeout = options.timeout;
+        if (options.totalTimeout >= 0) {
+            long long left = std::max(options.totalTimeout - (realtime_clock() - startTime), 0LL);
+            timeout = (long int)((timeout < 0)? left : std::min((long long)timeout, left));
+        }
+
+        TabuSearch<T> search(problem, initSol, options.tenure, seeds[read]);
+        search.setElitePool(options.eliteSize, options.pathRelinking);
+        search.setVisitedMinima(options.visitedMinima, options.maxRevisits);
+        search.run(timeout, options.numRestarts, options.energyThreshold, options.numWorkers, options.maxEvaluations,
+                   (options.callback != nullptr)? &readCallback.callback : nullptr, options.callbackInterval,
+                   &batchCancellation);
+        if (options.stopAllOnThreshold && search.bestEnergy() <= options.energyThreshold) {
+            batchCancellation.cancel();
+        }
+
+        if (outputs.samples != nullptr) {
+            const BitVector &solution = search.bestSolution();
+            std::copy(solution.data(), solution.data() + nWords, outputs.samples + read * nWords);
+        }
+        if (outputs.energies != nullptr) {
+            outputs.energies[read] = search.bestEnergy();
+        }
+        if (outputs.restarts != nullptr) {
+            outputs.restarts[read] = search.numRestarts();
+        }
+        if (outputs.iterations != nullptr) {
+            outputs.iterations[read] = search.numIterations();
+        }
+        if (outputs.evaluations != nullptr) {
+            outputs.evaluations[read] = search.numEvaluations();
+        }
+        const ElitePool &elites = search.elitePool();
+        for (int k = 0; k < elites.size(); k++) {
+            size_t slot = (size_t)read * options.eliteSize + k;
+            if (outputs.eliteSamples != nullptr) {
+                std::copy(elites.solution(k).data(), elites.solution(k).data() + nWords,
+                          outputs.eliteSamples + slot * nWords);
+            }
+            if (outputs.eliteEnergies != nullptr) {
+                outputs.eliteEnergies[slot] = problem->getObjective(elites.solution(k));
             }
-            C[i][j] = (solution[i] == solution[j])? -bqp.Q[i][j] : bqp.Q[i][j];
-            C[j][i] = C[i][j];
         }
-        C[i][i] = (solution[i] == 1)? -C[i][i] : C[i][i];
+        if (outputs.eliteCounts != nullptr) {
+            outputs.eliteCounts[read] = elites.size();
+        }
+        if (outputs.minima != nullptr) {
+            outputs.minima[read] = search.numMinima();
+        }
+        if (outputs.revisits != nullptr) {
+            outputs.revisits[read] = search.numRevisits();
+        }
+        if (outputs.revisitStops != nullptr) {
+            outputs.revisitStops[read] = search.numRevisitStops();
+        }
+        if (outputs.phases != nullptr) {
+            PhaseTimes times = search.phaseTimes();
+            times.ticks[PHASE_CONSTRUCT] = times.calls[PHASE_CONSTRUCT] = 0;  // The shared problem is counted once
+            std::lock_guard<std::mutex> lock(phasesMutex);
+            outputs.phases->add(times);
+        }
+    });
+}
+
+template <class T>
+void tabuSearchMany(int numProblems,
+                    const int *numVars,
+                    const T *linear,
+                    const std::int64_t *couplingOffsets,
+                    const int *irow,
+                    const int *icol,
+                    const T *values,
+                    int numReads,
+                    const std::int8_t *initStates,
+                    const unsigned int *seeds,
+                    int tenure,
+                    long int timeout,
+                    int numRestarts,
+                    double energyThreshold,
+                    long long maxEvaluations,
+                    int numThreads,
+                    std::int8_t *samples,
+                    double *energies) {
+
+    // Offset of the first variable of every problem
+    vector<std::size_t> varOffsets(numProblems + 1, 0);
+    for (int k = 0; k < numProblems; k++) {
+        varOffsets[k + 1] = varOffsets[k] + numVars[k];
     }
+
+    // Problems are built on the pool too, then shared by their reads
+    vector<std::shared_ptr<const BQP<T>>> problems(numProblems);
+    parallel_for(numProblems, numThreads, [&](int k) {
+        std::int64_t first = couplingOffsets[k];
+        problems[k] = std::make_shared<const BQP<T>>(numVars[k], linear + varOffsets[k],
+                                                     couplingOffsets[k + 1] - first, irow + first,
+                                                     icol + first, values + first);
+    });
+
+    parallel_for(numProblems * numReads, numThreads, [&](int task) {
+        int k = task / numReads;
+        int n = numVars[k];
+        std::size_t start = varOffsets[k] * numReads + (std::size_t)(task % numReads) * n;
+        if (n == 0) {
+            energies[task] = 0;
+            return;
+        }
+
+        vector<int> initSol(initStates + start, initStates + start + n);
+        TabuSearch<T> search(problems[k], initSol, tenure, timeout, numRestarts, seeds[task], energyThreshold, 1,
+                             maxEvaluations);
+        search.bestSolution().unpack(samples + start);
+        energies[task] = search.bestEnergy();
+    });
 }
+
+#define INSTANTIATE_TABU_SEARCH(T) \
+    template class TabuSearch<T>; \
+    template void tabuSearchBatch<T>(std::shared_ptr<const BQP<T>>, int, const std::int8_t *, const unsigned int *, \
+                                     const BatchOptions &, const BatchOutputs &); \
+    template void tabuSearchMany<T>(int, const int *, const T *, const std::int64_t *, const int *, const int *, \
+                                    const T *, int, const std::int8_t *, const unsigned int *, int, long int, int, \
+                                    double, long long, int, std::int8_t *, double *);
+
+INSTANTIATE_TABU_SEARCH(double)
+INSTANTIATE_TABU_SEARCH(float)
+INSTANTIATE_TABU_SEARCH(std::int32_t)
+INSTANTIATE_TABU_SEARCH(std::int64_t)
@@ -18,114 +18,400 @@
 #define LAMBDA 5000
 #define ALPHA 0.4
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <vector>
 #include <random>
 
+#include "bit_vector.h"
 #include "bqp.h"
+#include "elite_pool.h"
+#include "phase_timer.h"
+#include "zobrist.h"
 
+/**
+ * Current solution of a search and the statistics collected while searching
+ */
+struct SearchState {
+    BitVector solution;                     // Current solution, packed bits of size nVars
+    double solutionQuality = 0;             // Objective function value at solution
+    unsigned long long nIterations = 0;     // Number of iterations required to arrive at solution
+
+    /*added to record more statistics.*/
+    unsigned long long restartNum = 0;  // Number of times simpleTabuSearch runs
+    unsigned long long iterNum = 0;     // Number of times loop within simpleTabuSearch runs
+    unsigned long long evalNum = 0;
+    unsigned long long minimaNum = 0;       // Local minima reached, if tracked (see TabuSearch::setVisitedMinima)
+    unsigned long long revisitNum = 0;      // Of those, the ones reached before
+    unsigned long long revisitStopNum = 0;  // Tabu searches ended early by revisits
+    double upperBound = -std::numeric_limits<double>::max();
+    PhaseTimes phases;                      // Time per phase, if built with TABU_PHASE_TIMING
+};
+
+/**
+ * Progress of a search, as passed to a bqpSolver_Callback
+ */
+struct SearchProgress {
+    double bestEnergy;                      // Lowest energy found so far
+    unsigned long long restarts;            // Statistics of SearchState, summed over the workers
+    unsigned long long iterations;
+    unsigned long long evaluations;
+    double elapsed;                         // Seconds since the search started
+    int read;                               // Index of the read in tabuSearchBatch(), 0 otherwise
+};
+
+/**
+ * Progress callback. func returns non-zero to stop the search, and is called
+ * from the worker threads if numWorkers > 1 (never concurrently for one search).
+ */
 typedef struct bqpSolver_Callback {
-  void (*func)(const struct bqpSolver_Callback *callback, BQP *bqp);
+  int (*func)(const struct bqpSolver_Callback *callback, const SearchProgress *progress);
   void *context;
 } bqpSolver_Callback;
 
+/**
+ * Cooperative cancellation of searches. cancel() may be called from any
+ * thread; the searches given the token stop at their next check, at most one
+ * tabu search iteration later, and keep the best solution found so far.
+ * A token with a parent is also cancelled once the parent is. cancel() only
+ * stores to a lock-free atomic, so it is safe in a signal handler.
+ */
+class CancellationToken {
+    public:
+        explicit CancellationToken(const CancellationToken *parent = nullptr) : parent(parent), cancelled(false) {}
+
+        void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+        bool isCancelled() const {
+            return cancelled.load(std::memory_order_relaxed) || (parent != nullptr && parent->isCancelled());
+        }
+
+    private:
+        const CancellationToken *parent;
+        std::atomic<bool> cancelled;
+};
+
+static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "CancellationToken::cancel() needs a lock-free atomic bool");
+
+struct SharedBest;
+class MoveTree;
+class ProgressReporter;
+class TabuSearchBenchmark;
+
+/**
+ * Multistart tabu search over a BQP<T>. The changes in objective are kept in
+ * the coefficient type T, so that integer problems are updated exactly and
+ * float ones move half the memory of double; energies are always double.
+ */
+template <class T>
 class TabuSearch
 {
     public:
-        TabuSearch(std::vector<std::vector<double>> Q, 
-                   const std::vector<int> initSol, 
+        TabuSearch(const std::vector<std::vector<double>> &Q, 
+                   const std::vector<int> &initSol, 
+                   int tenure, 
+                   long int timeout, 
+                   int numRestarts, 
+                   unsigned int seed, 
+                   double energyThreshold,
+                   int numWorkers = 1,
+                   long long maxEvaluations = -1);
+
+        /**
+         * Same as above, for a problem that may be shared with other searches.
+         * With numWorkers > 1, the restarts of this one search are run by
+         * numWorkers threads that share the best solution found so far
+         * (see cooperativeRestarts()).
+         * With a negative timeout, a single worker and maxEvaluations >= 0, the
+         * search stops after a fixed amount of work and its result depends only
+         * on the problem, initSol, tenure and seed.
+         * The callback is called when the best energy improves, at most once
+         * every callbackInterval milliseconds, and once more when the search
+         * ends; the search stops once it returns non-zero.
+         * The search also stops once cancellation, if given, is cancelled.
+         */
+        TabuSearch(std::shared_ptr<const BQP<T>> problem,
+                   const std::vector<int> &initSol, 
                    int tenure, 
                    long int timeout, 
                    int numRestarts, 
                    unsigned int seed, 
-                   double energyThreshold);
+                   double energyThreshold,
+                   int numWorkers = 1,
+                   long long maxEvaluations = -1,
+                   const bqpSolver_Callback *callback = nullptr,
+                   long long callbackInterval = 0,
+                   const CancellationToken *cancellation = nullptr);
+
+        /**
+         * Prepares a search session without searching: validates initSol and
+         * tenure, and seeds the RNG. run() then searches, any number of times.
+         * \param problem: The problem, may be shared with other searches
+         * \param initSol: Starting solution
+         * \param tenure: Tabu tenure, 0 selects a default based on the problem size
+         * \param seed: RNG seed
+         */
+        TabuSearch(std::shared_ptr<const BQP<T>> problem,
+                   const std::vector<int> &initSol,
+                   int tenure,
+                   unsigned int seed);
+
+        /**
+         * Searches for up to timeout more milliseconds and numRestarts more
+         * restarts. The first run starts with a tabu search from initSol, later
+         * runs go on restarting from the best solution found so far, with the
+         * RNG where the previous run left it. Statistics accumulate over the runs.
+         * \param timeout: Time limit of this run in milliseconds, negative for no limit
+         * \param numRestarts: Number of restarts of this run
+         * \param energyThreshold: Run terminates when energy lower than threshold is found
+         * \param numWorkers: Number of threads running the restarts
+         * \param maxEvaluations: Run terminates once this many more moves are evaluated, per worker,
+         *                        negative for no limit
+         * \param callback: Optional progress callback, as above
+         * \param callbackInterval: Minimum time between two calls of callback, in milliseconds
+         * \param cancellation: Optional token, run terminates once it is cancelled
+         * \return
+         */
+        void run(long int timeout,
+                 int numRestarts,
+                 double energyThreshold = -std::numeric_limits<double>::max(),
+                 int numWorkers = 1,
+                 long long maxEvaluations = -1,
+                 const bqpSolver_Callback *callback = nullptr,
+                 long long callbackInterval = 0,
+                 const CancellationToken *cancellation = nullptr);
+
+        /**
+         * Keeps the best diverse solutions found from now on in a pool, whose
+         * elites differ in at least max(1, nVars / 100) variables (see ElitePool).
+         * With pathRelinking, every other restart then starts from a solution on
+         * the path between two elites, instead of perturbing the last solution,
+         * once the pool holds two elites far enough apart.
+         * \param size: Number of elites kept, 0 to keep none
+         * \param pathRelinking: Whether restarts relink elites
+         * \return
+         */
+        void setElitePool(int size, bool pathRelinking);
+
+        /**
+         * Remembers the local minima the tabu searches reach from now on, in a
+         * VisitedSet of Zobrist hashes of the solutions, updated in O(1) per
+         * flip. A local minimum is where a descent ends: a solution reached by
+         * an improving move that none of the moves allowed by the tabu list
+         * improves. Once a tabu search reaches more than maxRevisits minima
+         * reached before since it last improved on its best solution, it ends
+         * early, and the next restarts perturb twice as many variables as the
+         * previous one, until a tabu search ends otherwise.
+         * \param capacity: Number of minima remembered, rounded up to a power of two, 0 to track none
+         * \param maxRevisits: Revisits allowed per tabu search, negative to only count them
+         */
+        void setVisitedMinima(int capacity, int maxRevisits);
+
         double bestEnergy();
-        std::vector<int> bestSolution();
+        const BitVector &bestSolution();
+        const ElitePool &elitePool();
         int numRestarts();
+        unsigned long long numIterations();
+        unsigned long long numEvaluations();
+        unsigned long long numMinima();
+        unsigned long long numRevisits();
+        unsigned long long numRevisitStops();
+
+        /**
+         * Time spent per phase by the search and its workers, plus the
+         * construction of the problem. All zero unless built with TABU_PHASE_TIMING.
+         */
+        PhaseTimes phaseTimes();
 
     private:
+        // Times the phases of the search, see testscpp/benchmarks
+        friend class TabuSearchBenchmark;
+
         /**
-         * Simple tabu search solver with multi starts. Updates bqp with best solution found.
+         * Creates a worker for the cooperative restarts of another search
+         * \param problem: The problem
+         * \param tenure: Tabu tenure, already validated
+         * \param seed: RNG seed
+         */
+        TabuSearch(std::shared_ptr<const BQP<T>> problem, int tenure, unsigned int seed);
+
+        /**
+         * Simple tabu search solver with multi starts. Updates state with best solution found.
+         * The first call starts with a tabu search from the solution in state, later
+         * calls only restart.
          * \param timeLimitInMilliSecs: Time limit in milliseconds
          * \param numStarts: Number of re starts
          * \param energyThreshold: Search terminates when energy lower than threshold is found
-         * \param initSolution: Starting solution to start search from
-         * \param callback: Optional callback function
+         * \param numWorkers: Number of threads running the restarts
+         * \param progress: Optional progress reporter, updated from the worker threads if numWorkers > 1
          * \return
          */
         void multiStartTabuSearch(long long timeLimitInMilliSecs, 
                                   int numStarts, 
                                   double energyThreshold,
-                                  const std::vector<int> &initSolution, 
-                                  const bqpSolver_Callback *callback);
+                                  int numWorkers,
+                                  ProgressReporter *progress);
+
+        /**
+         * Worker loop of a cooperative multistart search. Each restart starts from
+         * the best solution published by any worker, if it is better than this
+         * worker's own, and publishes what it finds. Workers claim restarts from a
+         * shared budget and all stop once one of them meets the energy threshold
+         * or the time limit.
+         * \param shared: Best solution, restart budget and stop flag of all workers
+         * \param startTime: Start time of the search, from realtime_clock()
+         * \param timeLimitInMilliSecs: Time limit in milliseconds
+         * \param useTimeLimit: If false, timeLimitInMilliSecs is ignored
+         * \param energyThreshold: Search terminates when energy lower than threshold is found
+         * \param ZCoeff: Parameter used to define the max number of iterations
+         * \param progress: Optional progress reporter
+         * \return
+         */
+        void cooperativeRestarts(SharedBest &shared,
+                                 long long startTime,
+                                 long long timeLimitInMilliSecs,
+                                 bool useTimeLimit,
+                                 double energyThreshold,
+                                 long long ZCoeff,
+                                 ProgressReporter *progress);
+
+        /**
+         * Tells whether the work budget of the run, maxEvaluations, is used up
+         * \return True if no more moves may be evaluated
+         */
+        bool budgetSpent() const {
+            return maxEvaluations >= 0 && state.evalNum - runStartEvaluations >= (unsigned long long)maxEvaluations;
+        }
+
+        /**
+         * Tells whether the token of the run, if any, is cancelled
+         * \return True if the run must stop
+         */
+        bool cancelled() const {
+            return cancellation != nullptr && cancellation->isCancelled();
+        }
+
+        /**
+         * Perturbs the current solution by steepest ascent on a randomly selected
+         * group of variables (refer paper for multi start tabu search by Palubeckis)
+         * \param I: Storage for the selected variables
+         * \return
+         */
+        void perturb(std::vector<int> &I);
+
+        /**
+         * Sets the starting solution of the next restart: by path relinking on
+         * every other restart if enabled and possible, else by perturb()
+         * \param I: Storage for the selected variables
+         * \return
+         */
+        void restart(std::vector<int> &I);
+
+        /**
+         * Walks from an elite to another one picked at random, flipping at each
+         * step the variable where they still differ that lowers the objective most,
+         * and sets the current solution to the best one met between a quarter and
+         * three quarters of the way
+         * \return False if the pool has no two elites at least 4 variables apart
+         */
+        bool relink();
 
         /**
-         * Solves and updates the BQP using simple tabu search heuristic
+         * Solves and updates state using simple tabu search heuristic
          * \param starting: A starting solution
          * \param startingObjective: The objective function value for the starting solution
          * \param ZCoeff: Parameter used to define the max number of iterations
          * \param timeLimitInMilliSecs: Time limit in milli seconds
          * \param useTimeLimit: If false, timeLimitInMilliSecs is ignored
          * \param energyThreshold: Search terminates when energy lower than threshold is found
-         * \param callback: Optional callback function
+         * \param progress: Optional progress reporter
          * \return
          */
-        void simpleTabuSearch(const std::vector<int> &starting, 
+        void simpleTabuSearch(const BitVector &starting, 
                               double startingObjective, 
                               long long ZCoeff, 
                               long long timeLimitInMilliSecs, 
                               bool useTimeLimit, 
                               double energyThreshold,
-                              const bqpSolver_Callback *callback);
+                              ProgressReporter *progress);
 
         /**
-         * Solves and updates the BQP using basic local searching
+         * Solves and updates state using basic local searching
          * \param starting: A starting solution
          * \param startingObjective: The objective function value for the starting solution
          * \param changeInObjective: Partial derivative values for the starting solution
+         * \param startingHash: Zobrist hash of the starting solution, if tracking minima;
+         *                      that of the solution found is left in solutionHash
          * \return
          */
-        void localSearchInternal(const std::vector<int> &starting, 
+        void localSearchInternal(const BitVector &starting, 
                                  double startingObjective, 
-                                 std::vector<double> &changeInObjective);
+                                 std::vector<T> &changeInObjective,
+                                 std::uint64_t startingHash = 0);
+
+        /**
+         * Flips a variable and updates the change in objective of its neighbors
+         * \param k: Variable to flip
+         * \param solution: Current solution, updated
+         * \param sign: 1 - 2 * solution[i] for every variable, updated
+         * \param changeInObjective: Partial derivative values for solution, updated
+         * \param tree: Optional move tree over changeInObjective, updated (sparse problems only)
+         * \return
+         */
+        void flipVariable(int k,
+                          BitVector &solution,
+                          std::vector<T> &sign,
+                          std::vector<T> &changeInObjective,
+                          MoveTree *tree = nullptr);
         
         /**
          * Helper function to multiStartTabuSearch() function
          * Selects variables to change and build up new solution
          * \param numSelection: Number of variables required to be selected
-         * \param C: C matrix (refer paper for multi start tabu search by Palubeckis)
+         * \param diagonal: Diagonal of the C matrix (refer paper for multi start tabu search by Palubeckis),
+         *                  its other entries are computed from the couplings and the current solution
          * \param I: Storage for selected variables
          * \return
          */
         void selectVariables(int numSelection, 
-                             std::vector<std::vector<double>> &C, 
+                             const std::vector<double> &diagonal, 
                              std::vector<int> &I);
         
         /**
          * Helper function to multiStartTabuSearch() function
          * Uses steepest ascent to construct a new solution
          * \param numSelection: Number of variables required to be selected
-         * \param C: C matrix (refer paper for multi start tabu search by Palubeckis)
+         * \param diagonal: Diagonal of the C matrix, as for selectVariables()
          * \param I: Selected variables
          * \param solution: Solution to be updated
          * \return
          */
         void steepestAscent(int numSelection, 
-                            std::vector<std::vector<double>> &C, 
+                            const std::vector<double> &diagonal, 
                             std::vector<int> &I, 
-                            std::vector<int> &solution);
+                            BitVector &solution);
 
         /**
-         * Compute the C matrix (refer to the tabu search heuristic in the paper by Palubeckis (p.262))
-         * \param C: The matrix computed
+         * Compute the diagonal of the C matrix (refer to the tabu search heuristic in the paper by Palubeckis (p.262)),
+         * in O(n + number of couplings). Off the diagonal, C[i][j] is -(Q[i][j] + Q[j][i]) if solution[i] == solution[j]
+         * and Q[i][j] + Q[j][i] otherwise, so it is never stored.
+         * \param diagonal: The diagonal computed
          * \param solution: Current solution
          * \return
          */
-        void computeC(std::vector<std::vector<double>> &C, const std::vector<int> &solution);
+        void computeCDiagonal(std::vector<double> &diagonal, const BitVector &solution);
+
+        /**
+         * The problem, read-only
+         */
+        std::shared_ptr<const BQP<T>> bqp;
 
         /**
-         * Stores the problem, the solution, and some statistics
+         * Stores the solution, and some statistics
          */
-        BQP bqp;
+        SearchState state;
 
         /**
          * Number of previous solutions to keep track of
@@ -136,6 +422,198 @@ class TabuSearch
          * RNG
          */
         std::default_random_engine generator;
+
+        /**
+         * Work budget of a run, in evaluated moves (SearchState::evalNum), negative for no limit
+         */
+        long long maxEvaluations;
+
+        /**
+         * SearchState::evalNum when the current run started
+         */
+        unsigned long long runStartEvaluations;
+
+        /**
+         * Whether the tabu search from the starting solution has run
+         */
+        bool started;
+
+        /**
+         * Set by another worker to end this search early, nullptr when searching alone
+         */
+        const std::atomic<bool> *stopFlag;
+
+        /**
+         * Cancellation token of the current run, nullptr if none
+         */
+        const CancellationToken *cancellation;
+
+        /**
+         * Best diverse solutions found, empty unless enabled by setElitePool()
+         */
+        ElitePool elites;
+
+        /**
+         * Whether restarts relink elites
+         */
+        bool pathRelinking;
+
+        /**
+         * Keys of the variables if tracking local minima, else empty
+         */
+        ZobristKeys zobrist;
+
+        /**
+         * Hashes of the local minima reached
+         */
+        VisitedSet visitedMinima;
+
+        /**
+         * Revisits allowed per tabu search, negative for no limit
+         */
+        int maxRevisits;
+
+        /**
+         * Multiplier of the number of variables perturbed, doubled after a tabu search ended by revisits
+         */
+        int perturbScale;
+
+        /**
+         * Zobrist hash of the solution found by localSearchInternal()
+         */
+        std::uint64_t solutionHash;
+
+        /**
+         * Index of this worker in a cooperative search, 0 for the search itself
+         */
+        int worker;
+};
+
+/**
+ * Settings of tabuSearchBatch() shared by all its reads; the defaults are
+ * those of tabu_options_init() in the C interface
+ */
+struct BatchOptions {
+    int tenure = 0;                         // As for TabuSearch
+    long int timeout = 20;                  // As for TabuSearch, per read
+    int numRestarts = 1000000;              // As for TabuSearch, per read
+    double energyThreshold = -std::numeric_limits<double>::max();  // As for TabuSearch
+    int numWorkers = 1;                     // As for TabuSearch, per read
+    long long maxEvaluations = -1;          // As for TabuSearch, per read
+    int numThreads = 1;                     // Reads run at once, 0 for one per hardware thread
+
+    // Progress callback of all reads, or null; SearchProgress::read tells them
+    // apart, and the calls of different reads may be concurrent
+    const bqpSolver_Callback *callback = nullptr;
+    long long callbackInterval = 0;         // As for TabuSearch, per read
+
+    // All reads terminate once cancellation, if given, is cancelled, once
+    // totalTimeout milliseconds have passed since the call (if non-negative;
+    // reads started late get what is left of it, so return little more than
+    // their starting solution), and with stopAllOnThreshold, once one of them
+    // meets energyThreshold
+    const CancellationToken *cancellation = nullptr;
+    long int totalTimeout = -1;
+    bool stopAllOnThreshold = false;
+
+    int eliteSize = 0;                      // Elites kept per read, 0 for none (see TabuSearch::setElitePool)
+    bool pathRelinking = false;             // As for TabuSearch::setElitePool
+    int visitedMinima = 0;                  // Minima remembered per read, 0 for none (see TabuSearch::setVisitedMinima)
+    int maxRevisits = -1;                   // As for TabuSearch::setVisitedMinima
 };
 
+/**
+ * Where tabuSearchBatch() writes the results of its reads; each output is
+ * optional, and left alone if null
+ */
+struct BatchOutputs {
+    std::uint64_t *samples = nullptr;       // Best solution of every read, as a BitVector of (nVars + 63) / 64 words
+    double *energies = nullptr;             // Best energy of every read
+    int *restarts = nullptr;                // Number of restarts of every read
+    unsigned long long *iterations = nullptr;   // SearchState::iterNum of every read
+    unsigned long long *evaluations = nullptr;  // SearchState::evalNum of every read
+
+    // Time per phase, summed over the reads, with the construction of the
+    // problem counted once (all zero unless built with TABU_PHASE_TIMING)
+    PhaseTimes *phases = nullptr;
+
+    std::uint64_t *eliteSamples = nullptr;  // Elites of every read, best first, eliteSize packed solutions per read
+    double *eliteEnergies = nullptr;        // Energies of the elites, eliteSize per read
+    int *eliteCounts = nullptr;             // Number of elites of every read, at most eliteSize
+
+    unsigned long long *minima = nullptr;       // SearchState::minimaNum of every read
+    unsigned long long *revisits = nullptr;     // SearchState::revisitNum of every read
+    unsigned long long *revisitStops = nullptr; // SearchState::revisitStopNum of every read
+};
+
+/**
+ * Runs one multistart tabu search per read, all sharing the same problem, on
+ * a pool of options.numThreads threads. Reads are handed out one at a time to
+ * whichever thread is idle. Reads of numWorkers > 1 threads each run at most
+ * hardware threads / numWorkers at once, so that the threads of the reads
+ * and of their workers together do not oversubscribe the cores.
+ * \param problem: The problem
+ * \param numReads: Number of reads
+ * \param initStates: numReads x nVars row-major matrix of starting solutions
+ * \param seeds: RNG seed of every read
+ * \param options: Settings of the reads
+ * \param outputs: Where to write the results of the reads
+ * \return
+ */
+template <class T>
+void tabuSearchBatch(std::shared_ptr<const BQP<T>> problem,
+                     int numReads,
+                     const std::int8_t *initStates,
+                     const unsigned int *seeds,
+                     const BatchOptions &options,
+                     const BatchOutputs &outputs);
+
+/**
+ * Solves many small independent problems in one call, numReads reads each,
+ * on a pool of numThreads threads. The problems are given concatenated, in
+ * the form of the BQP constructor from a list of couplings: problem k has
+ * numVars[k] variables, whose linear biases follow those of problem k - 1,
+ * and couplings couplingOffsets[k] to couplingOffsets[k + 1] - 1, indexed
+ * from 0 within the problem. Solutions and starting states are concatenated
+ * likewise, the reads of a problem one after the other.
+ * \param numProblems: Number of problems
+ * \param numVars: Number of variables of every problem
+ * \param linear: Linear biases of all problems
+ * \param couplingOffsets: numProblems + 1 offsets into irow, icol and values
+ * \param irow: First variable of every coupling
+ * \param icol: Second variable of every coupling
+ * \param values: Value of every coupling, Q[i][j] + Q[j][i]
+ * \param numReads: Number of reads of every problem
+ * \param initStates: Starting solutions, numReads x numVars[k] values for problem k
+ * \param seeds: RNG seed of every read, numReads per problem
+ * \param tenure: As for TabuSearch, 0 for the default of each problem
+ * \param timeout: As for TabuSearch, per read
+ * \param numRestarts: As for TabuSearch, per read
+ * \param energyThreshold: As for TabuSearch
+ * \param maxEvaluations: As for TabuSearch, per read
+ * \param numThreads: Number of reads run at once, 0 for one per hardware thread
+ * \param samples: Output best solution of every read, laid out as initStates
+ * \param energies: Output best energy of every read, numReads per problem
+ * \return
+ */
+template <class T>
+void tabuSearchMany(int numProblems,
+                    const int *numVars,
+                    const T *linear,
+                    const std::int64_t *couplingOffsets,
+                    const int *irow,
+                    const int *icol,
+                    const T *values,
+                    int numReads,
+                    const std::int8_t *initStates,
+                    const unsigned int *seeds,
+                    int tenure,
+                    long int timeout,
+                    int numRestarts,
+                    double energyThreshold,
+                    long long maxEvaluations,
+                    int numThreads,
+                    std::int8_t *samples,
+                    double *energies);
+
 #endif
@@ -14,8 +14,75 @@
 
 #include "utils.h"
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "common.h"
 
+void parallel_for(int numTasks, int numThreads, const std::function<void(int)> &task) {
+    if (numThreads <= 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if (numThreads > numTasks) {
+        numThreads = numTasks;
+    }
+    if (numThreads <= 1) {
+        for (int i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<int> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        for (int i = next++; i < numTasks; i = next++) {
+            try {
+                task(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = numTasks;
+            }
+        }
+    };
+
+    // The calling thread is one of the workers
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+bool Deadline::readClock() {
+    long long now = realtime_clock();
+    if (now - lastRead < 1 && stride < (1 << 20)) {
+        stride *= 2;
+    }
+    else if (now - lastRead > 2 && stride > 1) {
+        stride /= 2;
+    }
+    lastRead = now;
+    countdown = stride;
+    return now > deadline;
+}
+
 #if defined(_WIN32) || defined(_WIN64)
 
 #include <Windows.h>
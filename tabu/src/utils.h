@@ -16,7 +16,45 @@
 
 #define _UTILS_H_
 
+#include <functional>
+
 // High-precision per-thread monotonic clock value expressed in milliseconds
 long long realtime_clock();
 
+// Tells whether a realtime_clock() deadline has passed, reading the clock only
+// every stride calls. The stride doubles while reads are less than a
+// millisecond apart and halves when they are more than two apart, which keeps
+// the clock out of hot loops and overshoots the deadline by about a millisecond,
+// as long as calls take about the same time. Callers call checkNext() after a
+// step much slower than the others, which a large stride would multiply.
+class Deadline {
+    public:
+        explicit Deadline(long long deadline)
+            : deadline(deadline), lastRead(realtime_clock()), stride(1), countdown(1) {}
+
+        bool passed() {
+            return --countdown <= 0 && readClock();
+        }
+
+        // Reads the clock on the next call, and restarts the stride from 1
+        void checkNext() {
+            stride = 1;
+            countdown = 1;
+        }
+
+    private:
+        bool readClock();
+
+        long long deadline;
+        long long lastRead;
+        int stride;
+        int countdown;
+};
+
+// Calls task(i) for every i in [0, numTasks) on up to numThreads threads
+// (one per hardware thread if numThreads <= 0). Every idle thread takes the
+// next index not yet taken, so uneven tasks stay balanced. Once a task
+// throws, no further tasks are started and the exception is rethrown here.
+void parallel_for(int numTasks, int numThreads, const std::function<void(int)> &task);
+
 #endif
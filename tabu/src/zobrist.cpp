@@ -0,0 +1,61 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#include "zobrist.h"
+
+#include "common.h"
+
+namespace {
+
+// SplitMix64, which turns consecutive integers into well mixed 64-bit keys
+std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+ZobristKeys::ZobristKeys(int size) : keys(size) {
+    for (int i = 0; i < size; i++) {
+        keys[i] = splitMix64(i);
+    }
+}
+
+std::uint64_t ZobristKeys::hash(const BitVector &solution) const {
+    std::uint64_t h = 0;
+    solution.forEachSet([&](int i) {
+        h ^= keys[i];
+    });
+    return h;
+}
+
+VisitedSet::VisitedSet(int capacity) : mask(0) {
+    if (capacity < 0) {
+        throw Exception("visited set capacity must be non-negative");
+    }
+    if (capacity > (1 << 30)) {
+        throw Exception("visited set capacity must be at most 2^30");
+    }
+    if (capacity > 0) {
+        std::size_t size = 1;
+        while (size < (std::size_t)capacity) {
+            size *= 2;
+        }
+        slots.assign(size, 0);
+        mask = size - 1;
+    }
+}
@@ -0,0 +1,94 @@
+//  Copyright 2022 D-Wave Systems Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#ifndef _ZOBRIST_H_
+
+#define _ZOBRIST_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_vector.h"
+
+/**
+ * Zobrist hashing of solutions: every variable has a random 64-bit key, and
+ * the hash of a solution is the XOR of the keys of its variables set to 1,
+ * so flipping variable i updates it in O(1) by XORing key(i). Keys depend
+ * only on the variable index, not on any search's RNG.
+ */
+class ZobristKeys
+{
+    public:
+        /**
+         * Draws the keys of size variables, none if size is 0
+         * @param size: Number of variables
+         */
+        explicit ZobristKeys(int size = 0);
+
+        int size() const { return (int)keys.size(); }
+
+        std::uint64_t key(int i) const { return keys[i]; }
+
+        /**
+         * Hashes a solution from scratch
+         * @param solution: Solution of size() variables
+         * @return Its hash
+         */
+        std::uint64_t hash(const BitVector &solution) const;
+
+    private:
+        std::vector<std::uint64_t> keys;
+};
+
+/**
+ * Bounded set of solution hashes, direct-mapped: every hash has a single
+ * slot, and takes it from whatever hash held it before. Hashes may thus be
+ * forgotten, but a hash is reported as present only if it was inserted
+ * (different solutions sharing a 64-bit hash aside). 0 is never stored.
+ */
+class VisitedSet
+{
+    public:
+        /**
+         * Builds an empty set
+         * @param capacity: Number of slots, rounded up to a power of two, 0 for a set storing nothing
+         */
+        explicit VisitedSet(int capacity = 0);
+
+        int capacity() const { return (int)slots.size(); }
+
+        /**
+         * Adds a hash
+         * @param hash: Hash
+         * @return True if the hash was already present
+         */
+        bool insert(std::uint64_t hash) {
+            if (slots.empty() || hash == 0) {
+                return false;
+            }
+            std::uint64_t &slot = slots[hash & mask];
+            if (slot == hash) {
+                return true;
+            }
+            slot = hash;
+            return false;
+        }
+
+    private:
+        std::vector<std::uint64_t> slots;
+        std::uint64_t mask;
+};
+
+#endif
@@ -12,18 +12,180 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from libc.stddef cimport ptrdiff_t
+from libc.stdint cimport int8_t, int64_t, uint64_t
+from libcpp.memory cimport shared_ptr
+from libcpp.string cimport string
 from libcpp.vector cimport vector
 
 
+cdef extern from "bit_vector.h" nogil:
+    cdef cppclass BitVector:
+        int size()
+        vector[int] toVector()
+
+
+cdef extern from "phase_timer.h" nogil:
+    cdef enum:
+        NUM_PHASES
+
+    cdef cppclass PhaseTimes:
+        double seconds(int phase)
+        unsigned long long count(int phase)
+
+    bint phaseTimingEnabled()
+    const char *phaseName(int phase)
+
+
+cdef extern from "problem_file.h" nogil:
+    cdef enum CoefficientType:
+        COEFFICIENT_DOUBLE
+        COEFFICIENT_FLOAT
+        COEFFICIENT_INT32
+        COEFFICIENT_INT64
+
+    cdef cppclass ProblemFile:
+        ProblemFile(const string &path) except +
+        CoefficientType coefficientType()
+        int numVariables()
+        string labels()
+
+
+cdef extern from "bqp.h" nogil:
+    cdef cppclass BQP[T]:
+        BQP(const T *Q,
+            int nRows,
+            int nCols,
+            ptrdiff_t rowStride,
+            ptrdiff_t colStride) except +
+        BQP(int nVars,
+            const T *linear,
+            size_t numCouplings,
+            const int *irow,
+            const int *icol,
+            const T *values) except +
+        BQP(shared_ptr[ProblemFile] file) except +
+        int nVars
+        PhaseTimes phases
+
+
+cdef extern from "problem_file.h" nogil:
+    void writeProblemFile[T](const string &path, const BQP[T] &bqp, const string &labels) except +
+
+
 cdef extern from "tabu_search.h" nogil:
-    cdef cppclass TabuSearch:
-        TabuSearch(vector[vector[double]] Q,
-                   const vector[int] initSol,
+    cdef struct SearchProgress:
+        double bestEnergy
+        unsigned long long restarts
+        unsigned long long iterations
+        unsigned long long evaluations
+        double elapsed
+        int read
+
+    cdef struct bqpSolver_Callback:
+        int (*func)(const bqpSolver_Callback *callback, const SearchProgress *progress) noexcept nogil
+        void *context
+
+    cdef cppclass CancellationToken:
+        CancellationToken(const CancellationToken *parent)
+        void cancel()
+        bint isCancelled()
+
+    cdef cppclass TabuSearch[T]:
+        TabuSearch(const vector[vector[double]] &Q,
+                   const vector[int] &initSol,
+                   int tenure,
+                   long int timeout,
+                   int numRestarts,
+                   unsigned int seed,
+                   double energyThreshold,
+                   int numWorkers,
+                   long long maxEvaluations) except +
+        TabuSearch(shared_ptr[BQP[T]] problem,
+                   const vector[int] &initSol,
                    int tenure,
                    long int timeout,
                    int numRestarts,
                    unsigned int seed,
-                   double energyThreshold) except +
+                   double energyThreshold,
+                   int numWorkers,
+                   long long maxEvaluations,
+                   const bqpSolver_Callback *callback,
+                   long long callbackInterval,
+                   const CancellationToken *cancellation) except +
+        TabuSearch(shared_ptr[BQP[T]] problem,
+                   const vector[int] &initSol,
+                   int tenure,
+                   unsigned int seed) except +
+        void run(long int timeout,
+                 int numRestarts,
+                 double energyThreshold,
+                 int numWorkers,
+                 long long maxEvaluations,
+                 const bqpSolver_Callback *callback,
+                 long long callbackInterval,
+                 const CancellationToken *cancellation) except +
         double bestEnergy()
-        vector[int] bestSolution()
+        const BitVector &bestSolution()
         int numRestarts()
+        unsigned long long numIterations()
+        unsigned long long numEvaluations()
+        PhaseTimes phaseTimes()
+
+    cdef cppclass BatchOptions:
+        int tenure
+        long int timeout
+        int numRestarts
+        double energyThreshold
+        int numWorkers
+        long long maxEvaluations
+        int numThreads
+        const bqpSolver_Callback *callback
+        long long callbackInterval
+        const CancellationToken *cancellation
+        long int totalTimeout
+        bint stopAllOnThreshold
+        int eliteSize
+        bint pathRelinking
+        int visitedMinima
+        int maxRevisits
+
+    cdef cppclass BatchOutputs:
+        uint64_t *samples
+        double *energies
+        int *restarts
+        unsigned long long *iterations
+        unsigned long long *evaluations
+        PhaseTimes *phases
+        uint64_t *eliteSamples
+        double *eliteEnergies
+        int *eliteCounts
+        unsigned long long *minima
+        unsigned long long *revisits
+        unsigned long long *revisitStops
+
+    void tabuSearchBatch[T](shared_ptr[BQP[T]] problem,
+                            int numReads,
+                            const int8_t *initStates,
+                            const unsigned int *seeds,
+                            const BatchOptions &options,
+                            const BatchOutputs &outputs) except +
+
+    void tabuSearchMany[T](int numProblems,
+                           const int *numVars,
+                           const T *linear,
+                           const int64_t *couplingOffsets,
+                           const int *irow,
+                           const int *icol,
+                           const T *values,
+                           int numReads,
+                           const int8_t *initStates,
+                           const unsigned int *seeds,
+                           int tenure,
+                           long int timeout,
+                           int numRestarts,
+                           double energyThreshold,
+                           long long maxEvaluations,
+                           int numThreads,
+                           int8_t *samples,
+                           double *energies) except +
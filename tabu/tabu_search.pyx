@@ -16,17 +16,382 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from libc.stddef cimport ptrdiff_t
+from libc.stdint cimport int8_t, int32_t, int64_t, uint64_t
+from libcpp.memory cimport shared_ptr, make_shared
+from libcpp.string cimport string
 from libcpp.vector cimport vector
 from libc.time cimport time
+from collections import namedtuple
+import os
+import threading
+
 import numpy as np
 
 cimport tabu
 
 
+ctypedef fused coefficient:
+    double
+    float
+    int32_t
+    int64_t
+
+
+def as_qubo(object Q):
+    """Convert `Q` to the coefficient type the search runs in.
+
+    float32 and float64 arrays are kept as they are. Integer arrays are
+    searched in int32 if no change in objective of a single flip can overflow
+    it, else in int64. Anything else is converted to float64.
+    """
+    Q = np.asarray(Q)
+    if Q.ndim != 2:
+        raise ValueError("Q must be a 2-dimensional array")
+    if Q.dtype == np.single or Q.dtype == np.double:
+        return Q
+    if not np.issubdtype(Q.dtype, np.integer):
+        return np.asarray(Q, dtype=np.double)
+
+    # A flip changes the objective by at most Q[i, i] + 2 sum_j!=i |Q[i, j]|
+    if Q.size:
+        magnitude = np.abs(Q.astype(np.double))
+        bound = (2 * magnitude.sum(axis=1) - magnitude.diagonal()[:len(magnitude)]).max()
+    else:
+        bound = 0
+    if bound <= np.iinfo(np.int32).max:
+        return np.asarray(Q, dtype=np.int32)
+    return np.asarray(Q, dtype=np.int64)
+
+
+def as_coefficients(object linear, object irow, object icol, object values):
+    """Convert the biases of a problem given as vectors to the coefficient
+    type the search runs in, by the rules of `as_qubo`.
+
+    Returns:
+        tuple: `linear` and `values` as arrays of one coefficient type.
+    """
+    linear = np.asarray(linear)
+    values = np.asarray(values)
+    dtype = np.result_type(linear, values)
+    if dtype == np.single or dtype == np.double:
+        return np.asarray(linear, dtype=dtype), np.asarray(values, dtype=dtype)
+    if not np.issubdtype(dtype, np.integer):
+        return np.asarray(linear, dtype=np.double), np.asarray(values, dtype=np.double)
+
+    # A flip changes the objective by at most |linear[i]| + sum of |values| of couplings of i
+    magnitude = np.abs(values.astype(np.double))
+    bound = np.abs(linear.astype(np.double))
+    if len(bound) and len(magnitude):
+        bound = (bound + np.bincount(np.asarray(irow, dtype=np.intp), magnitude, len(bound))
+                 + np.bincount(np.asarray(icol, dtype=np.intp), magnitude, len(bound)))
+    if not len(bound) or bound.max() <= np.iinfo(np.int32).max:
+        dtype = np.int32
+    else:
+        dtype = np.int64
+    return np.asarray(linear, dtype=dtype), np.asarray(values, dtype=dtype)
+
+
+Progress = namedtuple('Progress', ['read', 'energy', 'num_restarts', 'num_iterations', 'num_evaluations', 'elapsed'])
+Progress.__doc__ = """Progress of one read, passed to the progress callback of `tabu_search_batch`.
+
+`energy` is the best energy found so far, the counts are summed over the
+read's workers and `elapsed` is in seconds.
+"""
+
+
+Elites = namedtuple('Elites', ['samples', 'energies', 'counts'])
+Elites.__doc__ = """Best diverse solutions of every read, as returned by `tabu_search_batch`.
+
+`samples` is a `(num_reads, elite_size, num_vars)` int8 array and
+`energies` a `(num_reads, elite_size)` array, both sorted from the best
+solution of each read; read `r` has `counts[r]` elites, and its unused slots
+hold zeros and infinite energies.
+"""
+
+
+Revisits = namedtuple('Revisits', ['minima', 'revisits', 'stops'])
+Revisits.__doc__ = """Local minima reached by every read, as returned by `tabu_search_batch`.
+
+`minima` counts the local minima each read reached, `revisits` those of them
+it had reached before, and `stops` its tabu searches ended by revisits, all
+as `num_reads` arrays.
+"""
+
+
+PhaseTime = namedtuple('PhaseTime', ['seconds', 'calls'])
+PhaseTime.__doc__ = """Time spent in one phase of the search and the number of times it ran."""
+
+PHASE_TIMING = tabu.phaseTimingEnabled()
+"""Whether the extension was built with TABU_PHASE_TIMING set, so that phase times are recorded."""
+
+
+cdef dict phase_times(const tabu.PhaseTimes &times):
+    """Convert `PhaseTimes` to a dict of `PhaseTime` by phase name, empty unless `PHASE_TIMING`."""
+    if not PHASE_TIMING:
+        return {}
+    return {tabu.phaseName(p).decode(): PhaseTime(times.seconds(p), times.count(p))
+            for p in range(tabu.NUM_PHASES)}
+
+
+cdef class ProgressHook:
+    """Calls a Python progress callback from the search threads.
+
+    Once the callback returns a true value or raises, every search reporting
+    to this hook is asked to stop; the exception is kept in `error`.
+    """
+
+    cdef object function
+    cdef object error
+    cdef bint stop
+
+    def __cinit__(self, object function):
+        self.function = function
+        self.error = None
+        self.stop = False
+
+    cdef int call(self, const tabu.SearchProgress *progress):
+        if self.stop:
+            return 1
+        try:
+            if self.function(Progress(progress.read, progress.bestEnergy, progress.restarts,
+                                      progress.iterations, progress.evaluations, progress.elapsed)):
+                self.stop = True
+        except BaseException as error:
+            self.error = error
+            self.stop = True
+        return self.stop
+
+
+cdef int call_progress_hook(const tabu.bqpSolver_Callback *callback,
+                            const tabu.SearchProgress *progress) noexcept nogil:
+    with gil:
+        return (<ProgressHook>callback.context).call(progress)
+
+
+cdef shared_ptr[tabu.BQP[coefficient]] make_problem(const coefficient[:, :] Q) except *:
+    """Build a `BQP` that reads `Q` in place, whatever its strides."""
+    cdef const coefficient *qubo = NULL
+    if Q.shape[0] and Q.shape[1]:
+        qubo = &Q[0, 0]
+    cdef int rows = Q.shape[0]
+    cdef int cols = Q.shape[1]
+    cdef ptrdiff_t rowStride = Q.strides[0] // sizeof(coefficient)
+    cdef ptrdiff_t colStride = Q.strides[1] // sizeof(coefficient)
+
+    cdef tabu.BQP[coefficient] *bqp
+    with nogil:
+        bqp = new tabu.BQP[coefficient](qubo, rows, cols, rowStride, colStride)
+    return shared_ptr[tabu.BQP[coefficient]](bqp)
+
+
+cdef shared_ptr[tabu.BQP[coefficient]] make_sparse_problem(const coefficient[::1] linear,
+                                                           const int[::1] irow,
+                                                           const int[::1] icol,
+                                                           const coefficient[::1] values) except *:
+    """Build a `BQP` from linear biases and a list of couplings."""
+    cdef int num_vars = linear.shape[0]
+    cdef size_t num_couplings = values.shape[0]
+    cdef const coefficient *_linear = &linear[0] if num_vars else NULL
+    cdef const int *_irow = &irow[0] if num_couplings else NULL
+    cdef const int *_icol = &icol[0] if num_couplings else NULL
+    cdef const coefficient *_values = &values[0] if num_couplings else NULL
+
+    cdef tabu.BQP[coefficient] *bqp
+    with nogil:
+        bqp = new tabu.BQP[coefficient](num_vars, _linear, num_couplings, _irow, _icol, _values)
+    return shared_ptr[tabu.BQP[coefficient]](bqp)
+
+
+cdef class Problem:
+    """A QUBO prepared for the search: converted by `as_qubo`, validated and
+    laid out once.
+
+    A `Problem` is immutable, so one can be shared by any number of searches,
+    threads and calls of `tabu_search_batch` and `TabuSearch`, which then
+    skip conversion and validation.
+
+    `Problem(Q)` prepares a QUBO matrix; `Problem.from_vectors` prepares a
+    problem given in sparse form, without a matrix, and `Problem.from_file`
+    maps a problem file written by `write`.
+    """
+
+    cdef readonly object dtype
+    cdef readonly int num_variables
+    cdef readonly bytes labels
+    cdef shared_ptr[tabu.BQP[double]] _double
+    cdef shared_ptr[tabu.BQP[float]] _float
+    cdef shared_ptr[tabu.BQP[int32_t]] _int32
+    cdef shared_ptr[tabu.BQP[int64_t]] _int64
+
+    def __cinit__(self):
+        self.labels = b''
+
+    def __init__(self, object Q):
+        Q = as_qubo(Q)
+        self.dtype = Q.dtype
+        if Q.dtype == np.double:
+            self._double = make_problem[double](Q)
+            self.num_variables = self._double.get().nVars
+        elif Q.dtype == np.single:
+            self._float = make_problem[float](Q)
+            self.num_variables = self._float.get().nVars
+        elif Q.dtype == np.int32:
+            self._int32 = make_problem[int32_t](Q)
+            self.num_variables = self._int32.get().nVars
+        else:
+            self._int64 = make_problem[int64_t](Q)
+            self.num_variables = self._int64.get().nVars
+
+    @staticmethod
+    def from_vectors(object linear, object irow, object icol, object values):
+        """Prepare a problem from its linear biases and a list of couplings,
+        as returned by `dimod.BinaryQuadraticModel.to_numpy_vectors` for a
+        binary BQM.
+
+        Coupling `k` adds `values[k]` to the objective when variables
+        `irow[k]` and `icol[k]` are both 1, so `values` are the full
+        quadratic biases, not halved as in the matrix `Q`. Couplings listed
+        more than once are summed. Memory and time are linear in the number
+        of couplings; the search still lays out dense problems as a matrix.
+        The coefficient type is chosen by `as_coefficients`.
+        """
+        linear, values = as_coefficients(linear, irow, icol, values)
+        irow = np.ascontiguousarray(irow, dtype=np.intc)
+        icol = np.ascontiguousarray(icol, dtype=np.intc)
+        if linear.ndim != 1 or values.ndim != 1 or not len(irow) == len(icol) == len(values):
+            raise ValueError("irow, icol and values must be vectors of the same length")
+        linear = np.ascontiguousarray(linear)
+        values = np.ascontiguousarray(values)
+
+        cdef Problem problem = Problem.__new__(Problem)
+        problem.dtype = linear.dtype
+        problem.num_variables = len(linear)
+        if linear.dtype == np.double:
+            problem._double = make_sparse_problem[double](linear, irow, icol, values)
+        elif linear.dtype == np.single:
+            problem._float = make_sparse_problem[float](linear, irow, icol, values)
+        elif linear.dtype == np.int32:
+            problem._int32 = make_sparse_problem[int32_t](linear, irow, icol, values)
+        else:
+            problem._int64 = make_sparse_problem[int64_t](linear, irow, icol, values)
+        return problem
+
+    @staticmethod
+    def from_file(object path):
+        """Map a problem file written by `write`.
+
+        Sparse problems are searched in the mapped file itself, so processes
+        loading the same file share one page-cached copy and start without
+        parsing it; the file stays mapped as long as the problem exists. The
+        labels stored in the file are available as `labels`.
+        """
+        cdef string _path = _encode_path(path)
+        cdef shared_ptr[tabu.ProblemFile] file
+        with nogil:
+            file = make_shared[tabu.ProblemFile](_path)
+
+        cdef Problem problem = Problem.__new__(Problem)
+        cdef tabu.CoefficientType coefficients = file.get().coefficientType()
+        with nogil:
+            if coefficients == tabu.COEFFICIENT_DOUBLE:
+                problem._double = make_shared[tabu.BQP[double]](file)
+            elif coefficients == tabu.COEFFICIENT_FLOAT:
+                problem._float = make_shared[tabu.BQP[float]](file)
+            elif coefficients == tabu.COEFFICIENT_INT32:
+                problem._int32 = make_shared[tabu.BQP[int32_t]](file)
+            else:
+                problem._int64 = make_shared[tabu.BQP[int64_t]](file)
+        problem.dtype = np.dtype([np.double, np.single, np.int32, np.int64][coefficients])
+        problem.num_variables = file.get().numVariables()
+        problem.labels = file.get().labels()
+        return problem
+
+    def write(self, object path, bytes labels=b''):
+        """Write the problem to a problem file, for `from_file`, storing
+        `labels` along with it."""
+        cdef string _path = _encode_path(path)
+        cdef string _labels = labels
+        with nogil:
+            if self._double:
+                tabu.writeProblemFile[double](_path, self._double.get()[0], _labels)
+            elif self._float:
+                tabu.writeProblemFile[float](_path, self._float.get()[0], _labels)
+            elif self._int32:
+                tabu.writeProblemFile[int32_t](_path, self._int32.get()[0], _labels)
+            else:
+                tabu.writeProblemFile[int64_t](_path, self._int64.get()[0], _labels)
+
+    cdef tabu.PhaseTimes construction_times(self):
+        """Time spent preparing the problem, by phase."""
+        if self._double:
+            return self._double.get().phases
+        elif self._float:
+            return self._float.get().phases
+        elif self._int32:
+            return self._int32.get().phases
+        else:
+            return self._int64.get().phases
+
+
+cdef string _encode_path(object path):
+    """Encode a path for the native layer."""
+    return os.fsencode(path)
+
+
+cdef Problem as_problem(object Q):
+    """Return `Q` if it is a `Problem`, else prepare one from it."""
+    if isinstance(Q, Problem):
+        return Q
+    return Problem(Q)
+
+
+cdef shared_ptr[tabu.TabuSearch[coefficient]] make_session(shared_ptr[tabu.BQP[coefficient]] problem,
+                                                           const vector[int] &initSol,
+                                                           int tenure,
+                                                           unsigned int seed) except *:
+    """Build a `TabuSearch` session on `problem`, without searching yet."""
+    cdef tabu.TabuSearch[coefficient] *search
+    with nogil:
+        search = new tabu.TabuSearch[coefficient](problem, initSol, tenure, seed)
+    return shared_ptr[tabu.TabuSearch[coefficient]](search)
+
+
+cdef tuple run_session(tabu.TabuSearch[coefficient] *search,
+                       int timeout,
+                       int numRestarts,
+                       double energyThreshold,
+                       int numWorkers,
+                       long long maxEvaluations):
+    """Run a session once more and return its best energy, solution and statistics."""
+    with nogil:
+        search.run(timeout, numRestarts, energyThreshold, numWorkers, maxEvaluations, NULL, 0, NULL)
+    return (search.bestEnergy(), search.bestSolution().toVector(), search.numRestarts(),
+            search.numIterations(), search.numEvaluations(), phase_times(search.phaseTimes()))
+
+
 cdef class TabuSearch:
-    """Wraps the class `TabuSearch` from `src/tabu_search.cpp`."""
+    """Wraps the class `TabuSearch` from `src/tabu_search.cpp`.
+
+    `Q` is a QUBO matrix or a `Problem`. The search runs in the coefficient
+    type chosen by `as_qubo`. Constructing
+    it runs a first search; `run` searches more, restarting from the best
+    solution found so far with the RNG where the previous run left it, so
+    the problem is converted and validated only once.
+    """
 
-    cdef tabu.TabuSearch *c_tabu
+    cdef object _dtype
+    cdef shared_ptr[tabu.TabuSearch[double]] _double
+    cdef shared_ptr[tabu.TabuSearch[float]] _float
+    cdef shared_ptr[tabu.TabuSearch[int32_t]] _int32
+    cdef shared_ptr[tabu.TabuSearch[int64_t]] _int64
+
+    cdef double _bestEnergy
+    cdef list _bestSolution
+    cdef int _numRestarts
+    cdef unsigned long long _numIterations
+    cdef unsigned long long _numEvaluations
+    cdef dict _phaseTimes
 
     def __cinit__(self,
                   object Q,
@@ -35,35 +400,475 @@ cdef class TabuSearch:
                   int timeout,
                   int numRestarts,
                   object seed=None,
-                  object energyThreshold=None):
+                  object energyThreshold=None,
+                  int numWorkers=1,
+                  object maxEvaluations=None):
         cdef unsigned int _seed = time(NULL) if seed is None else seed
-        cdef double _energyThreshold = -np.inf if energyThreshold is None else energyThreshold
 
-        cdef double[:,:] qubo = np.asarray(Q, dtype=np.double)
-        cdef vector[vector[double]] Qvec
-        Qvec.resize(qubo.shape[0])
-        cdef Py_ssize_t i, j
-        for i in range(qubo.shape[0]):
-            for j in range(qubo.shape[1]):
-                Qvec[i].push_back(qubo[i, j])
+        cdef Problem problem = as_problem(Q)
 
         cdef int[:] initial = np.asarray(initSol, dtype=np.intc)
         cdef vector[int] initVec
+        cdef Py_ssize_t i
         for i in range(len(initial)):
             initVec.push_back(initial[i])
 
-        with nogil:
-            self.c_tabu = new tabu.TabuSearch(
-                Qvec, initVec, tenure, timeout, numRestarts, _seed, _energyThreshold)
+        self._dtype = problem.dtype
+        if problem.dtype == np.double:
+            self._double = make_session[double](problem._double, initVec, tenure, _seed)
+        elif problem.dtype == np.single:
+            self._float = make_session[float](problem._float, initVec, tenure, _seed)
+        elif problem.dtype == np.int32:
+            self._int32 = make_session[int32_t](problem._int32, initVec, tenure, _seed)
+        else:
+            self._int64 = make_session[int64_t](problem._int64, initVec, tenure, _seed)
 
-    def __dealloc__(self):
-        del self.c_tabu
+        self.run(timeout, numRestarts, energyThreshold, numWorkers, maxEvaluations)
+
+    def run(self,
+            int timeout,
+            int numRestarts,
+            object energyThreshold=None,
+            int numWorkers=1,
+            object maxEvaluations=None):
+        """Search for up to `timeout` more milliseconds (negative for no
+        limit) and `numRestarts` more restarts. `energyThreshold` and
+        `maxEvaluations` bound this run only; the statistics accumulate.
+        """
+        cdef double _energyThreshold = -np.inf if energyThreshold is None else energyThreshold
+        cdef long long _maxEvaluations = -1 if maxEvaluations is None else maxEvaluations
+
+        if self._dtype == np.double:
+            result = run_session[double](self._double.get(), timeout, numRestarts, _energyThreshold,
+                                         numWorkers, _maxEvaluations)
+        elif self._dtype == np.single:
+            result = run_session[float](self._float.get(), timeout, numRestarts, _energyThreshold,
+                                        numWorkers, _maxEvaluations)
+        elif self._dtype == np.int32:
+            result = run_session[int32_t](self._int32.get(), timeout, numRestarts, _energyThreshold,
+                                          numWorkers, _maxEvaluations)
+        else:
+            result = run_session[int64_t](self._int64.get(), timeout, numRestarts, _energyThreshold,
+                                          numWorkers, _maxEvaluations)
+        (self._bestEnergy, self._bestSolution, self._numRestarts,
+         self._numIterations, self._numEvaluations, self._phaseTimes) = result
 
     def bestEnergy(self):
-        return self.c_tabu.bestEnergy()
+        return self._bestEnergy
 
     def bestSolution(self):
-        return self.c_tabu.bestSolution()
+        return self._bestSolution
 
     def numRestarts(self):
-        return self.c_tabu.numRestarts()
+        return self._numRestarts
+
+    def numIterations(self):
+        return self._numIterations
+
+    def numEvaluations(self):
+        return self._numEvaluations
+
+    def phaseTimes(self):
+        """Dict of `PhaseTime` by phase name, including the construction of
+        the problem, or empty if the extension was built without phase timing.
+        """
+        return self._phaseTimes
+
+
+cdef class Cancellation:
+    """A token to stop running searches from any thread.
+
+    Searches given the token, by `tabu_search_batch` or
+    `TabuSampler.sample`, stop within one tabu iteration of a call of
+    `cancel` and return the best solutions found so far. A cancelled token
+    stays cancelled, so later searches given it return at once. A token made
+    with a `parent` is also cancelled once the parent is.
+    """
+
+    cdef tabu.CancellationToken *token
+    cdef readonly Cancellation parent
+
+    def __cinit__(self, Cancellation parent=None):
+        cdef const tabu.CancellationToken *parent_token = NULL
+        if parent is not None:
+            parent_token = parent.token
+        self.parent = parent
+        self.token = new tabu.CancellationToken(parent_token)
+
+    def __dealloc__(self):
+        del self.token
+
+    def cancel(self):
+        """Stop the searches given this token or a token made from it."""
+        self.token.cancel()
+
+    @property
+    def cancelled(self):
+        """Whether this token or its parent is cancelled."""
+        return self.token.isCancelled()
+
+
+cdef int search_batch(shared_ptr[tabu.BQP[coefficient]] problem, BatchSearch search) except -1 nogil:
+    """Typed call of `tabuSearchBatch`."""
+    tabu.tabuSearchBatch(problem, search.num_reads, search.states, search.seeds, search.options, search.outputs)
+    return 0
+
+
+cdef class BatchSearch:
+    """One call of `tabuSearchBatch` on a `Problem`, which `run` makes from
+    whatever thread it is called on, keeping an exception in `error` and
+    setting `done` once the search has stopped."""
+
+    cdef Problem problem
+    cdef int num_reads
+    cdef const int8_t *states
+    cdef const unsigned int *seeds
+    cdef tabu.BatchOptions options
+    cdef tabu.BatchOutputs outputs
+    cdef object error
+    cdef object done
+
+    def __cinit__(self):
+        self.done = threading.Event()
+
+    def run(self):
+        cdef Problem problem = self.problem
+        try:
+            with nogil:
+                if problem._double:
+                    search_batch[double](problem._double, self)
+                elif problem._float:
+                    search_batch[float](problem._float, self)
+                elif problem._int32:
+                    search_batch[int32_t](problem._int32, self)
+                else:
+                    search_batch[int64_t](problem._int64, self)
+        except BaseException as error:
+            self.error = error
+        finally:
+            self.done.set()
+
+
+cdef run_interruptibly(BatchSearch search, Cancellation cancellation):
+    """Run `search`, cancelling it if the calling thread is interrupted.
+
+    Python runs signal handlers in the main thread only, between bytecodes,
+    so a search called from the main thread runs on a helper thread while
+    the main thread waits. An exception raised in the main thread meanwhile,
+    such as `KeyboardInterrupt`, cancels the search and is re-raised once the
+    search has stopped.
+
+    The wait is on `search.done` rather than `Thread.join`: before Python
+    3.13, a join interrupted by an exception can mark a running thread as
+    stopped (CPython gh-90882), and the search writes into buffers that are
+    freed once this returns.
+    """
+    if threading.current_thread() is not threading.main_thread():
+        search.run()
+    else:
+        threading.Thread(target=search.run, daemon=True).start()
+        try:
+            while not search.done.wait(0.05):
+                pass
+        except BaseException:
+            cancellation.cancel()
+            # A second interrupt must not return before the search stops either
+            while not search.done.is_set():
+                try:
+                    search.done.wait(0.05)
+                except BaseException:
+                    pass
+            raise
+    if search.error is not None:
+        raise search.error
+
+
+def tabu_search_batch(object Q,
+                      object initial_states,
+                      object seeds,
+                      int tenure,
+                      int timeout,
+                      int num_restarts,
+                      object energy_threshold=None,
+                      int num_workers=1,
+                      int num_threads=1,
+                      object max_evaluations=None,
+                      object progress=None,
+                      double progress_interval=0,
+                      Cancellation cancellation=None,
+                      object total_timeout=None,
+                      bint stop_all_on_threshold=False,
+                      int elite_size=0,
+                      bint path_relinking=False,
+                      int visited_minima=0,
+                      int max_revisits=-1):
+    """Run one multistart tabu search per initial state on a native thread pool.
+
+    `Q` is a QUBO matrix, converted once by `as_qubo`, or a `Problem`
+    prepared beforehand; either way it is shared by all reads. `num_threads`
+    reads run at a time, each on `num_workers` cooperating threads. The GIL is
+    released while searching. `max_evaluations` bounds the number of moves
+    evaluated per read (per worker), None for no limit.
+
+    `progress`, if given, is called with a `Progress` whenever the best energy
+    of a read improves, at most once every `progress_interval` seconds per
+    read, and when the read ends. Calls hold the GIL, so they never overlap.
+    Returning a true value stops all reads at their next report; an
+    exception stops them too and is re-raised.
+
+    All reads stop early, keeping their best solutions so far, once
+    `cancellation` is cancelled, once `total_timeout` milliseconds have passed
+    since the call (reads started late get what is left of it), or, with
+    `stop_all_on_threshold`, once any read reaches `energy_threshold`. When
+    called from the main thread, a `KeyboardInterrupt` also stops all reads,
+    and is then re-raised.
+
+    With `elite_size` > 0, every read keeps its `elite_size` best solutions
+    that differ in at least 1% of the variables, and with `path_relinking`,
+    every other restart starts on the path between two of them rather than
+    from a perturbation of the last solution.
+
+    With `visited_minima` > 0, every read remembers up to `visited_minima`
+    local minima it reached (rounded up to a power of two, newer minima taking
+    the place of older ones), by Zobrist hashes of the solutions, and counts
+    the ones reached again. With `max_revisits`
+    >= 0, a tabu search that reaches more than `max_revisits` of them since it
+    last improved on its best solution ends early, and the next restarts
+    perturb twice as many variables, until one ends otherwise.
+
+    Returns:
+        tuple: best solutions as a `(num_reads, num_vars)` int8 array, their
+        energies, numbers of restarts, iterations and evaluated moves as
+        `num_reads` arrays, and the time per phase summed over the reads as
+        returned by `TabuSearch.phaseTimes`; followed, if `elite_size` > 0,
+        by the `Elites` of the reads, and if `visited_minima` > 0, by their
+        `Revisits`.
+    """
+    cdef Problem problem = as_problem(Q)
+    cdef int num_vars = problem.num_variables
+    if elite_size < 0:
+        raise ValueError("elite_size must be non-negative")
+    if path_relinking and elite_size < 2:
+        raise ValueError("path relinking takes an elite_size of at least 2")
+    if visited_minima < 0:
+        raise ValueError("visited_minima must be non-negative")
+
+    initial_states = np.atleast_2d(np.ascontiguousarray(initial_states, dtype=np.int8))
+    if initial_states.ndim != 2 or initial_states.shape[1] != num_vars:
+        raise ValueError("length of initial states doesn't match the size of Q")
+
+    cdef const int8_t[:, ::1] states = initial_states
+    cdef int num_reads = states.shape[0]
+    cdef const unsigned int[::1] _seeds = np.ascontiguousarray(seeds, dtype=np.uintc)
+    if _seeds.shape[0] != num_reads:
+        raise ValueError("number of seeds doesn't match the number of initial states")
+
+    # Solutions come back packed 64 variables to a word, variable i in bit i % 64
+    packed = np.zeros((num_reads, (num_vars + 63) // 64), dtype=np.uint64)
+    energies = np.zeros(num_reads, dtype=np.double)
+    restarts = np.zeros(num_reads, dtype=np.intc)
+    iterations = np.zeros(num_reads, dtype=np.ulonglong)
+    evaluations = np.zeros(num_reads, dtype=np.ulonglong)
+    elite_packed = np.zeros((num_reads, elite_size, (num_vars + 63) // 64), dtype=np.uint64)
+    elite_energies = np.full((num_reads, elite_size), np.inf)
+    elite_counts = np.zeros(num_reads, dtype=np.intc)
+    revisits = Revisits(np.zeros(num_reads, dtype=np.ulonglong), np.zeros(num_reads, dtype=np.ulonglong),
+                        np.zeros(num_reads, dtype=np.ulonglong))
+    if not num_reads or not num_vars:
+        # Nothing to search: every read of an empty problem has energy 0 and no statistics
+        result = (np.zeros((num_reads, num_vars), dtype=np.int8), energies, restarts, iterations, evaluations,
+                  phase_times(problem.construction_times()))
+        if elite_size:
+            result += (Elites(np.zeros((num_reads, elite_size, num_vars), dtype=np.int8), elite_energies,
+                              elite_counts),)
+        if visited_minima:
+            result += (revisits,)
+        return result
+
+    cdef ProgressHook hook = None
+    cdef tabu.bqpSolver_Callback callback
+    if progress is not None:
+        hook = ProgressHook(progress)
+        callback.func = call_progress_hook
+        callback.context = <void *>hook
+
+    # The call gets a token of its own, so that an interrupt cancels this call only
+    cdef Cancellation call_cancellation = Cancellation(cancellation)
+
+    cdef uint64_t[:, ::1] _samples = packed
+    cdef double[::1] _energies = energies
+    cdef int[::1] _restarts = restarts
+    cdef unsigned long long[::1] _iterations = iterations
+    cdef unsigned long long[::1] _evaluations = evaluations
+    cdef tabu.PhaseTimes phases
+    cdef uint64_t[:, :, ::1] _elite_samples = elite_packed
+    cdef double[:, ::1] _elite_energies = elite_energies
+    cdef int[::1] _elite_counts = elite_counts
+    cdef unsigned long long[::1] _minima = revisits.minima
+    cdef unsigned long long[::1] _revisits = revisits.revisits
+    cdef unsigned long long[::1] _revisit_stops = revisits.stops
+
+    cdef BatchSearch search = BatchSearch()
+    search.problem = problem
+    search.num_reads = num_reads
+    search.states = &states[0, 0]
+    search.seeds = &_seeds[0]
+
+    search.options.tenure = tenure
+    search.options.timeout = timeout
+    search.options.numRestarts = num_restarts
+    search.options.energyThreshold = -np.inf if energy_threshold is None else energy_threshold
+    search.options.numWorkers = num_workers
+    search.options.maxEvaluations = -1 if max_evaluations is None else max_evaluations
+    search.options.numThreads = num_threads
+    search.options.callback = &callback if hook is not None else NULL
+    search.options.callbackInterval = <long long>(progress_interval * 1000)
+    search.options.cancellation = call_cancellation.token
+    search.options.totalTimeout = -1 if total_timeout is None else total_timeout
+    search.options.stopAllOnThreshold = stop_all_on_threshold
+    search.options.eliteSize = elite_size
+    search.options.pathRelinking = path_relinking
+    search.options.visitedMinima = visited_minima
+    search.options.maxRevisits = max_revisits
+
+    search.outputs.samples = &_samples[0, 0]
+    search.outputs.energies = &_energies[0]
+    search.outputs.restarts = &_restarts[0]
+    search.outputs.iterations = &_iterations[0]
+    search.outputs.evaluations = &_evaluations[0]
+    search.outputs.phases = &phases
+    search.outputs.eliteSamples = &_elite_samples[0, 0, 0] if elite_size else NULL
+    search.outputs.eliteEnergies = &_elite_energies[0, 0] if elite_size else NULL
+    search.outputs.eliteCounts = &_elite_counts[0]
+    search.outputs.minima = &_minima[0]
+    search.outputs.revisits = &_revisits[0]
+    search.outputs.revisitStops = &_revisit_stops[0]
+    run_interruptibly(search, call_cancellation)
+    if hook is not None and hook.error is not None:
+        raise hook.error
+
+    samples = np.unpackbits(packed.astype('<u8', copy=False).view(np.uint8), axis=1,
+                            count=num_vars, bitorder='little').view(np.int8)
+    result = samples, energies, restarts, iterations, evaluations, phase_times(phases)
+    if elite_size:
+        elite_samples = np.unpackbits(elite_packed.astype('<u8', copy=False).view(np.uint8), axis=2,
+                                      count=num_vars, bitorder='little').view(np.int8)
+        result += (Elites(elite_samples, elite_energies, elite_counts),)
+    if visited_minima:
+        result += (revisits,)
+    return result
+
+
+ctypedef fused floating:
+    double
+    float
+
+
+cdef run_many(const int[::1] num_vars,
+              const floating[::1] linear,
+              const int64_t[::1] offsets,
+              const int[::1] irow,
+              const int[::1] icol,
+              const floating[::1] values,
+              int num_reads,
+              const int8_t[::1] states,
+              const unsigned int[::1] seeds,
+              int tenure,
+              int timeout,
+              int num_restarts,
+              double energy_threshold,
+              long long max_evaluations,
+              int num_threads,
+              int8_t[::1] samples,
+              double[::1] energies):
+    """Typed body of `tabu_search_many`."""
+    # Memoryviews of length 0 have no first element to point to
+    cdef const floating *_linear = &linear[0] if linear.shape[0] else NULL
+    cdef const int *_irow = &irow[0] if irow.shape[0] else NULL
+    cdef const int *_icol = &icol[0] if icol.shape[0] else NULL
+    cdef const floating *_values = &values[0] if values.shape[0] else NULL
+    cdef const int8_t *_states = &states[0] if states.shape[0] else NULL
+    cdef int8_t *_samples = &samples[0] if samples.shape[0] else NULL
+    with nogil:
+        tabu.tabuSearchMany(num_vars.shape[0], &num_vars[0], _linear, &offsets[0], _irow, _icol, _values,
+                            num_reads, _states, &seeds[0], tenure, timeout, num_restarts, energy_threshold,
+                            max_evaluations, num_threads, _samples, &energies[0])
+
+
+def tabu_search_many(object num_vars,
+                     object linear,
+                     object offsets,
+                     object irow,
+                     object icol,
+                     object values,
+                     object initial_states,
+                     object seeds,
+                     int tenure,
+                     int timeout,
+                     int num_restarts,
+                     object energy_threshold=None,
+                     int num_threads=1,
+                     object max_evaluations=None):
+    """Run `len(seeds) // len(num_vars)` reads on each of many small independent
+    problems, on a native thread pool.
+
+    The problems are given concatenated in a sparse form: problem `k` has
+    `num_vars[k]` variables, with linear biases following those of problem
+    `k - 1` in `linear`, and the couplings `offsets[k]` to `offsets[k + 1] - 1`
+    of `irow`, `icol` and `values`, indexed from 0 within the problem. A
+    coupling's value is its full quadratic bias, as in a binary BQM. Problems
+    are searched in float32 if `linear` and `values` both are, else in float64.
+
+    `initial_states` concatenates the reads of each problem, `num_vars[k]`
+    values per read of problem `k`, and `seeds` holds one seed per read in the
+    same order. A `tenure` of 0 selects the default of each problem. The GIL
+    is released while searching.
+
+    Returns:
+        tuple: the best solution of every read as an int8 array laid out as
+        `initial_states` and their energies, one per read.
+    """
+    cdef double _energyThreshold = -np.inf if energy_threshold is None else energy_threshold
+    cdef long long _maxEvaluations = -1 if max_evaluations is None else max_evaluations
+
+    num_vars = np.ascontiguousarray(num_vars, dtype=np.intc)
+    offsets = np.ascontiguousarray(offsets, dtype=np.int64)
+    irow = np.ascontiguousarray(irow, dtype=np.intc)
+    icol = np.ascontiguousarray(icol, dtype=np.intc)
+    initial_states = np.ascontiguousarray(initial_states, dtype=np.int8).ravel()
+    seeds = np.ascontiguousarray(seeds, dtype=np.uintc)
+
+    linear = np.asarray(linear)
+    values = np.asarray(values)
+    dtype = np.single if linear.dtype == np.single and values.dtype == np.single else np.double
+    linear = np.ascontiguousarray(linear, dtype=dtype)
+    values = np.ascontiguousarray(values, dtype=dtype)
+
+    cdef int num_problems = len(num_vars)
+    if not num_problems:
+        return np.empty(0, dtype=np.int8), np.empty(0, dtype=np.double)
+    if len(seeds) % num_problems:
+        raise ValueError("number of seeds must be a multiple of the number of problems")
+    cdef int num_reads = len(seeds) // num_problems
+    if not num_reads:
+        return np.empty(0, dtype=np.int8), np.empty(0, dtype=np.double)
+
+    if (num_vars < 0).any() or len(linear) != num_vars.sum():
+        raise ValueError("length of linear doesn't match num_vars")
+    if (len(offsets) != num_problems + 1 or offsets[0] != 0 or (np.diff(offsets) < 0).any()
+            or not len(irow) == len(icol) == len(values) == offsets[-1]):
+        raise ValueError("offsets don't match the couplings")
+    if len(initial_states) != num_reads * len(linear):
+        raise ValueError("length of initial states doesn't match num_vars")
+
+    samples = np.empty(len(initial_states), dtype=np.int8)
+    energies = np.empty(len(seeds), dtype=np.double)
+    if dtype == np.single:
+        run_many[float](num_vars, linear, offsets, irow, icol, values, num_reads, initial_states, seeds,
+                        tenure, timeout, num_restarts, _energyThreshold, _maxEvaluations, num_threads,
+                        samples, energies)
+    else:
+        run_many[double](num_vars, linear, offsets, irow, icol, values, num_reads, initial_states, seeds,
+                         tenure, timeout, num_restarts, _energyThreshold, _maxEvaluations, num_threads,
+                         samples, energies)
+    return samples, energies
@@ -0,0 +1,77 @@
+# Copyright 2022 D-Wave Systems Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import tempfile
+import unittest
+
+import dimod
+import numpy as np
+
+import tabu
+from tabu.problem_file import write_problem_file, read_problem_file
+from tabu.tabu_search import Problem, tabu_search_batch
+
+
+class TestProblemFile(unittest.TestCase):
+
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.directory.name, 'problem.tabubqp')
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def test_problem_round_trip(self):
+        bqm = dimod.generators.random.randint(30, 'BINARY', seed=123)
+        linear, (irow, icol, values), *_ = bqm.to_numpy_vectors()
+        init = [[1] * 30, [0] * 30]
+
+        for dtype in (np.double, np.single, np.int32, np.int64):
+            problem = Problem.from_vectors(linear.astype(dtype), irow, icol, values.astype(dtype))
+            problem.write(self.path, b'labels')
+            mapped = Problem.from_file(self.path)
+            self.assertEqual(mapped.dtype, problem.dtype)
+            self.assertEqual(mapped.num_variables, 30)
+            self.assertEqual(mapped.labels, b'labels')
+
+            # The mapped problem is searched as the one written
+            samples, energies, *_ = tabu_search_batch(mapped, init, [1, 2], 5, -1, 10)
+            reference = tabu_search_batch(problem, init, [1, 2], 5, -1, 10)
+            np.testing.assert_array_equal(samples, reference[0])
+            np.testing.assert_array_equal(energies, reference[1])
+
+    def test_bqm_round_trip(self):
+        bqm = dimod.BQM({'a': 1.5, ('b', 1): -1}, {('a', ('b', 1)): 2, ('a', 3): -0.5}, 0.25, 'SPIN')
+        write_problem_file(bqm, self.path)
+
+        stored = read_problem_file(self.path)
+        self.assertEqual(stored.variables, list(bqm.variables))
+        self.assertIs(stored.vartype, dimod.SPIN)
+        self.assertEqual(stored.offset, bqm.binary.offset)
+        self.assertEqual(stored.problem.num_variables, 3)
+
+    def test_invalid_files(self):
+        with self.assertRaises(RuntimeError):
+            Problem.from_file(os.path.join(self.directory.name, 'missing'))
+
+        with open(self.path, 'wb') as f:
+            f.write(b'\0' * 256)
+        with self.assertRaises(RuntimeError):
+            Problem.from_file(self.path)
+
+        # A problem file without the labels of write_problem_file
+        Problem([[1, 0], [0, 1]]).write(self.path)
+        with self.assertRaises(ValueError):
+            read_problem_file(self.path)
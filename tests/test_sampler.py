@@ -14,12 +14,15 @@
 
 """Test the TabuSampler python interface."""
 
+import os
+import tempfile
 import unittest
 
 import dimod
 import numpy as np
 
 import tabu
+import tabu.problem_file
 from tabu.utils import tictoc
 
 
@@ -238,6 +241,54 @@ class TestTabuSampler(unittest.TestCase):
             response = sampler.sample(bqm, num_reads=3, timeout=200, seed=123)
         self.assertAlmostEqual(tt.dt, 0.6, places=1)
 
+    def test_max_evaluations(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
+
+        # A work budget makes runs reproducible, however long they take
+        kwargs = dict(num_reads=3, timeout=None, max_evaluations=10**6, seed=345)
+        response0 = sampler.sample(bqm, **kwargs)
+        response1 = sampler.sample(bqm, **kwargs)
+        np.testing.assert_array_equal(response0.record.sample, response1.record.sample)
+        np.testing.assert_array_equal(response0.record.num_restarts, response1.record.num_restarts)
+        self.assertTrue(all(response0.record.num_restarts < 1000000))
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, max_evaluations=-1)
+
+    def test_progress_callback(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
+
+        reports = []
+        response = sampler.sample(bqm, num_reads=2, timeout=None, num_restarts=100, seed=345,
+                                  progress_callback=reports.append, progress_interval=0)
+
+        # The last report of a read has the energy of its sample and its statistics
+        for read in range(2):
+            last = [report for report in reports if report.read == read][-1]
+            self.assertAlmostEqual(last.energy, response.record.energy[read])
+            self.assertEqual(last.num_restarts, response.record.num_restarts[read])
+            self.assertEqual(last.num_iterations, response.record.num_iterations[read])
+            self.assertEqual(last.num_evaluations, response.record.num_evaluations[read])
+            self.assertGreaterEqual(last.elapsed, 0)
+
+        self.assertEqual(response.info['num_restarts'], 200)
+        self.assertEqual(response.info['num_evaluations'], response.record.num_evaluations.sum())
+        self.assertGreater(response.info['sampling_time'], 0)
+        self.assertEqual('phase_times' in response.info, tabu.tabu_search.PHASE_TIMING)
+
+        # Returning True stops sampling early
+        with tictoc() as tt:
+            sampler.sample(bqm, num_reads=2, timeout=100000, progress_callback=lambda report: True)
+        self.assertLess(tt.dt, 1.0)
+
+        with self.assertRaises(TypeError):
+            sampler.sample(bqm, progress_callback=1)
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, progress_callback=print, progress_interval=-1)
+
     def test_num_restarts(self):
         sampler = tabu.TabuSampler()
         bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
@@ -258,3 +309,179 @@ class TestTabuSampler(unittest.TestCase):
             response = sampler.sample(bqm, timeout=100000, energy_threshold=energy_threshold, seed=345)
 
         self.assertLessEqual(tt.dt, 1.0)
+
+    def test_stopping(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(30, 'SPIN', seed=123)
+        endless = dict(num_reads=3, timeout=None, num_restarts=10**9, seed=345)
+
+        cancellation = tabu.Cancellation()
+        cancellation.cancel()
+        response = sampler.sample(bqm, cancellation=cancellation, **endless)
+        self.assertEqual(response.info['num_iterations'], 0)
+
+        with tictoc() as tt:
+            sampler.sample(bqm, total_timeout=100, **endless)
+        self.assertAlmostEqual(tt.dt, 0.1, places=1)
+
+        # Reads run one after another, so the first one to meet the threshold
+        # stops the others before they start
+        large = dimod.generators.random.randint(100, 'SPIN', seed=123)
+        with tictoc() as tt:
+            response = sampler.sample(large, energy_threshold=-400, stop_all_on_threshold=True,
+                                      **endless)
+        self.assertLessEqual(tt.dt, 1.0)
+        self.assertEqual(sorted(response.record.num_iterations > 0), [False, False, True])
+
+        with self.assertRaises(TypeError):
+            sampler.sample(bqm, cancellation=True)
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, total_timeout=-1)
+
+    def test_elites(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(30, 'SPIN', seed=123)
+
+        for path_relinking in [False, True]:
+            response = sampler.sample(bqm, num_reads=2, elite_size=3, path_relinking=path_relinking,
+                                      timeout=None, max_evaluations=10**6, seed=345)
+            self.assertLessEqual(len(response), 6)
+            read = response.record.read
+            self.assertEqual(set(read), {0, 1})
+            for r in [0, 1]:
+                energies = response.record.energy[read == r]
+                self.assertEqual(energies[0], energies.min())
+                self.assertEqual(len(set(map(tuple, response.record.sample[read == r]))),
+                                 len(energies))
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, elite_size=0)
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, path_relinking=True)
+
+    def test_revisits(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(30, 'SPIN', seed=123)
+
+        response = sampler.sample(bqm, num_reads=2, visited_minima=1000, max_revisits=0,
+                                  timeout=None, max_evaluations=10**6, seed=345)
+        record = response.record
+        self.assertTrue((record.num_revisits <= record.num_minima).all())
+        self.assertTrue((record.num_revisit_stops > 0).all())
+        self.assertEqual(response.info['num_revisit_stops'], record.num_revisit_stops.sum())
+        self.assertNotIn('num_minima', sampler.sample(bqm, timeout=10).info)
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, visited_minima=0)
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, max_revisits=1)
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, visited_minima=10, max_revisits=-1)
+
+    def test_num_threads(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
+
+        # Reads are independent of how they are spread over threads
+        kwargs = dict(num_reads=10, timeout=None, num_restarts=10, seed=345)
+        response1 = sampler.sample(bqm, num_threads=1, **kwargs)
+        response4 = sampler.sample(bqm, num_threads=4, **kwargs)
+        dimod.testing.assert_response_energies(response4, bqm)
+        np.testing.assert_array_equal(response1.record.sample, response4.record.sample)
+
+        # Reads run side by side
+        with tictoc() as tt:
+            sampler.sample(bqm, num_reads=3, timeout=200, num_threads=3)
+        self.assertLess(tt.dt, 0.5)
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, num_threads=-1)
+
+    def test_num_workers(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
+
+        response = sampler.sample(bqm, num_reads=2, timeout=None, num_restarts=10, num_workers=3)
+        dimod.testing.assert_response_energies(response, bqm)
+        np.testing.assert_array_equal(response.record.num_restarts, [10, 10])
+
+        with self.assertRaises(ValueError):
+            sampler.sample(bqm, num_workers=0)
+
+    def test_large_sparse(self):
+        # A dense matrix of this size would take 20 GB
+        n = 50000
+        bqm = dimod.BQM({v: (-1) ** v for v in range(n)}, {(v, v + 1): 1 for v in range(n - 1)},
+                        0, 'SPIN')
+        response = tabu.TabuSampler().sample(bqm, timeout=None, num_restarts=1, max_evaluations=10 * n)
+        self.assertEqual(len(response.record.sample[0]), n)
+        dimod.testing.assert_response_energies(response, bqm)
+
+    def test_sample_file(self):
+        bqm = dimod.generators.random.randint(20, 'SPIN', seed=7)
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, 'problem.tabubqp')
+            tabu.problem_file.write_problem_file(bqm, path)
+
+            sampler = tabu.TabuSampler()
+            response = sampler.sample_file(path, num_reads=3, timeout=None, num_restarts=10, seed=2)
+            self.assertEqual(len(response), 3)
+            self.assertIs(response.vartype, dimod.SPIN)
+            self.assertEqual(list(response.variables), list(bqm.variables))
+            dimod.testing.assert_response_energies(response, bqm)
+
+            reference = sampler.sample(bqm, timeout=None, num_restarts=10, seed=2)
+            self.assertAlmostEqual(response.first.energy, reference.first.energy)
+
+            with self.assertRaises(ValueError):
+                sampler.sample_file(path, tenure=20)
+
+    def test_problem_cache(self):
+        sampler = tabu.TabuSampler()
+        bqm = dimod.generators.random.randint(10, 'SPIN', seed=123)
+
+        # The same contents map to the same prepared problem
+        first = sampler.sample(bqm, num_reads=2, timeout=None, num_restarts=10, seed=5)
+        problem, _ = sampler._prepare(bqm.binary)
+        again = sampler.sample(dimod.generators.random.randint(10, 'SPIN', seed=123),
+                               num_reads=2, timeout=None, num_restarts=10, seed=5)
+        self.assertIs(sampler._prepare(bqm.binary)[0], problem)
+        self.assertEqual(len(sampler._problems), 1)
+        np.testing.assert_array_equal(first.record.sample, again.record.sample)
+
+        # Changed contents are prepared anew, and the cache stays bounded
+        for seed in range(sampler.problem_cache_size + 1):
+            other = dimod.generators.random.randint(10, 'SPIN', seed=seed)
+            response = sampler.sample(other, num_reads=1, timeout=None, num_restarts=10)
+            dimod.testing.assert_response_energies(response, other)
+        self.assertEqual(len(sampler._problems), sampler.problem_cache_size)
+
+    def test_sample_many(self):
+        sampler = tabu.TabuSampler()
+        bqms = [dimod.generators.random.randint(n, vartype, seed=n)
+                for n, vartype in [(6, 'SPIN'), (15, 'BINARY'), (1, 'SPIN'), (9, 'BINARY')]]
+        bqms.append(dimod.BQM({}, {}, 0, 'SPIN'))
+
+        samplesets = sampler.sample_many(bqms, num_reads=3, timeout=None, num_restarts=10,
+                                         seed=4, num_threads=2)
+        self.assertEqual(len(samplesets), len(bqms))
+        for bqm, sampleset in zip(bqms, samplesets):
+            self.assertEqual(len(sampleset), 3)
+            self.assertEqual(set(sampleset.variables), set(bqm.variables))
+            self.assertIs(sampleset.vartype, bqm.vartype)
+            dimod.testing.assert_response_energies(sampleset, bqm)
+
+        # Small problems are solved to optimality, as one at a time
+        for bqm, sampleset in zip(bqms[:4], samplesets):
+            reference = sampler.sample(bqm, timeout=None, num_restarts=10, seed=1)
+            self.assertAlmostEqual(sampleset.first.energy, reference.first.energy)
+
+        again = sampler.sample_many(bqms, num_reads=3, timeout=None, num_restarts=10, seed=4)
+        for sampleset, other in zip(samplesets, again):
+            np.testing.assert_array_equal(sampleset.record.sample, other.record.sample)
+
+        self.assertEqual(sampler.sample_many([]), [])
+        with self.assertRaises(ValueError):
+            sampler.sample_many(bqms, num_reads=0)
+        with self.assertRaises(ValueError):
+            sampler.sample_many(bqms, tenure=5)
@@ -14,6 +14,8 @@
 
 """Test the (private) TabuSearch python interface."""
 
+import _thread
+import threading
 import unittest
 from concurrent.futures import ThreadPoolExecutor, wait
 
@@ -26,6 +28,13 @@ from tabu.utils import tictoc
 
 class TestTabuSearch(unittest.TestCase):
 
+    def setUp(self):
+        # Most tests search one random 30-variable problem, from all ones
+        self.bqm = dimod.generators.random.randint(30, 'BINARY', seed=123)
+        self.Q, _ = tabu.TabuSampler._bqm_to_tabu_qubo(self.bqm)
+        self.init = [[1] * 30] * 3
+        self.seeds = [1, 2, 3]
+
     def test_trivial(self):
         qubo = [[1.0]]
         init = [1]
@@ -73,6 +82,391 @@ class TestTabuSearch(unittest.TestCase):
                 wait([executor.submit(search, timeout=500) for _ in range(4)])
             self.assertTrue(0.9 < tt.dt < 2.1)
 
+    def test_batch(self):
+        qubo = [[-1.2, 1.1], [1.1, -1.2]]
+        init = [[1, 1], [0, 0], [1, 0]]
+        seeds = [1, 2, 3]
+
+        for num_threads in [1, 2, 0]:
+            with self.subTest(num_threads=num_threads):
+                samples, energies, restarts, _, _, _ = tabu.tabu_search.tabu_search_batch(
+                    qubo, init, seeds, 1, 20, 100, num_threads=num_threads)
+
+                self.assertEqual(samples.shape, (3, 2))
+                for sample in samples:
+                    self.assertIn(list(sample), [[0, 1], [1, 0]])
+                np.testing.assert_array_equal(energies, [-1.2] * 3)
+                self.assertTrue(all(0 <= r <= 100 for r in restarts))
+
+        # Errors in a read are raised to the caller
+        with self.assertRaises(RuntimeError):
+            tabu.tabu_search.tabu_search_batch(qubo, init, seeds, 3, 20, 100, num_threads=2)
+
+        with self.assertRaises(ValueError):
+            tabu.tabu_search.tabu_search_batch(qubo, [[1, 1, 1]], [1], 1, 20, 100)
+
+    def test_batch_empty(self):
+        # Reads of a problem without variables have energy 0 and no statistics
+        samples, energies, restarts, iterations, evaluations, _, revisits = tabu.tabu_search.tabu_search_batch(
+            np.zeros((0, 0)), np.zeros((3, 0)), [1, 2, 3], 0, 20, 100, visited_minima=10)
+        self.assertEqual(samples.shape, (3, 0))
+        for result in (energies, restarts, iterations, evaluations) + tuple(revisits):
+            np.testing.assert_array_equal(result, [0, 0, 0])
+
+    def test_cooperative_workers(self):
+        Q, init = self.Q, self.init[0]
+        tenure = 5
+
+        reference = tabu.TabuSearch(Q, init, tenure, 200, 1000, 1).bestEnergy()
+
+        for num_workers in [2, 4]:
+            with self.subTest(num_workers=num_workers):
+                # Workers share the restart budget
+                search = tabu.TabuSearch(Q, init, tenure, -1, 20, 1, None, num_workers)
+                self.assertEqual(search.numRestarts(), 20)
+
+                search = tabu.TabuSearch(Q, init, tenure, 200, 1000, 1, None, num_workers)
+                solution = np.array(search.bestSolution())
+                self.assertAlmostEqual(search.bestEnergy(), solution @ Q @ solution)
+                self.assertLessEqual(search.bestEnergy(), reference + 1e-9)
+
+                # All workers stop once one of them meets the threshold
+                with tictoc() as tt:
+                    search = tabu.TabuSearch(Q, init, tenure, 5000, 10**6, 1, reference, num_workers)
+                self.assertLessEqual(search.bestEnergy(), reference + 1e-9)
+                self.assertLess(tt.dt, 2)
+
+        with self.assertRaises(RuntimeError):
+            tabu.TabuSearch(Q, init, tenure, 10, 10, 1, None, 0)
+
+    def test_max_evaluations(self):
+        Q, init = self.Q, self.init[0]
+        tenure = 5
+
+        # No budget, no search
+        search = tabu.TabuSearch(Q, init, tenure, -1, 10**6, 1, None, 1, 0)
+        self.assertEqual(list(search.bestSolution()), init)
+        self.assertEqual(search.numRestarts(), 0)
+
+        # The budget, not the restart count, ends the search and results are reproducible
+        searches = [tabu.TabuSearch(Q, init, tenure, -1, 10**6, 7, None, 1, 10**7) for _ in range(2)]
+        self.assertEqual(list(searches[0].bestSolution()), list(searches[1].bestSolution()))
+        self.assertEqual(searches[0].numRestarts(), searches[1].numRestarts())
+        self.assertLess(searches[0].numRestarts(), 10**6)
+
+        longer = tabu.TabuSearch(Q, init, tenure, -1, 10**6, 7, None, 1, 4 * 10**7)
+        self.assertGreater(longer.numRestarts(), searches[0].numRestarts())
+
+    def test_progress(self):
+        Q, init, seeds = self.Q, self.init, self.seeds
+
+        reports = []
+        samples, energies, restarts, iterations, evaluations, _ = tabu.tabu_search.tabu_search_batch(
+            Q, init, seeds, 5, -1, 10**6, max_evaluations=10**6, progress=reports.append)
+
+        # Every read reports improvements, then its final statistics
+        for read in range(3):
+            mine = [report for report in reports if report.read == read]
+            self.assertGreater(len(mine), 1)
+            self.assertEqual([r.energy for r in mine], sorted([r.energy for r in mine], reverse=True))
+            self.assertEqual(mine[-1].energy, energies[read])
+            self.assertEqual(mine[-1].num_restarts, restarts[read])
+            self.assertEqual(mine[-1].num_iterations, iterations[read])
+            self.assertEqual(mine[-1].num_evaluations, evaluations[read])
+            self.assertGreaterEqual(evaluations[read], 10**6)
+
+        # Returning True stops all reads
+        with tictoc() as tt:
+            tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, 10**6, 10**9, progress=lambda report: True)
+        self.assertLess(tt.dt, 2)
+
+        # So do exceptions, which are re-raised
+        def fail(report):
+            raise KeyError("stop")
+
+        with tictoc() as tt:
+            with self.assertRaises(KeyError):
+                tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, 10**6, 10**9, progress=fail)
+        self.assertLess(tt.dt, 2)
+
+    def test_cancellation(self):
+        Q, init, seeds = self.Q, self.init, self.seeds
+        endless = dict(tenure=5, timeout=-1, num_restarts=10**9)
+
+        # A cancelled token stops reads before their first iteration
+        cancellation = tabu.Cancellation()
+        cancellation.cancel()
+        samples, _, _, iterations, _, _ = tabu.tabu_search.tabu_search_batch(
+            Q, init, seeds, cancellation=cancellation, **endless)
+        np.testing.assert_array_equal(samples, init)
+        np.testing.assert_array_equal(iterations, 0)
+
+        # Tokens made from it are cancelled too
+        self.assertTrue(tabu.Cancellation(cancellation).cancelled)
+        self.assertFalse(tabu.Cancellation().cancelled)
+
+        # Cancelling from another thread stops running reads
+        cancellation = tabu.Cancellation()
+        threading.Timer(0.1, cancellation.cancel).start()
+        with tictoc() as tt:
+            tabu.tabu_search.tabu_search_batch(Q, init, seeds, num_threads=2, num_workers=2,
+                                               cancellation=cancellation, **endless)
+        self.assertLess(tt.dt, 2)
+
+        # So does a KeyboardInterrupt, which is re-raised
+        threading.Timer(0.1, _thread.interrupt_main).start()
+        with tictoc() as tt:
+            with self.assertRaises(KeyboardInterrupt):
+                tabu.tabu_search.tabu_search_batch(Q, init, seeds, **endless)
+        self.assertLess(tt.dt, 2)
+
+    def test_total_timeout(self):
+        # A fourth read, so that the last ones get what is left of the time
+        Q = self.Q
+        init = self.init + [[1] * 30]
+        seeds = self.seeds + [4]
+
+        # Reads share the time limit, the last ones getting what is left;
+        # without it, reads with no time limit of their own would not end.
+        # Only upper bounds are checked, as busy machines run late.
+        with tictoc() as tt:
+            tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, -1, 10**9, total_timeout=200)
+        self.assertLess(tt.dt, 2)
+
+        # A generous total time limit leaves the 20 ms limit of each read
+        with tictoc() as tt:
+            tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, 20, 10**9, total_timeout=10**6)
+        self.assertLess(tt.dt, 1)
+
+    def test_stop_all_on_threshold(self):
+        qubo = [[-1.2, 1.1], [1.1, -1.2]]
+        init = [[1, 1]] * 3
+        seeds = [1, 2, 3]
+
+        # Reads run one after another, so the first one to meet the
+        # threshold stops the others before they start
+        _, energies, _, iterations, _, _ = tabu.tabu_search.tabu_search_batch(
+            qubo, init, seeds, 1, -1, 10**9, energy_threshold=-1.2, stop_all_on_threshold=True)
+        self.assertEqual(energies[0], -1.2)
+        np.testing.assert_array_equal(iterations[1:], 0)
+
+        _, energies, _, iterations, _, _ = tabu.tabu_search.tabu_search_batch(
+            qubo, init, seeds, 1, -1, 10**9, energy_threshold=-1.2)
+        np.testing.assert_array_equal(energies, -1.2)
+        self.assertTrue(all(iterations > 0))
+
+    def test_elites(self):
+        Q, init, seeds = self.Q, self.init, self.seeds
+
+        for path_relinking in [False, True]:
+            with self.subTest(path_relinking=path_relinking):
+                kwargs = dict(max_evaluations=10**6, elite_size=4, path_relinking=path_relinking)
+                *result, elites = tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, -1, 10**6, **kwargs)
+                self.assertEqual(elites.samples.shape, (3, 4, 30))
+                self.assertEqual(elites.energies.shape, (3, 4))
+
+                # The best elite of every read is its best solution
+                np.testing.assert_array_equal(elites.samples[:, 0], result[0])
+                np.testing.assert_array_equal(elites.energies[:, 0], result[1])
+
+                for read in range(3):
+                    count = elites.counts[read]
+                    self.assertGreater(count, 1)
+                    samples, energies = elites.samples[read, :count], elites.energies[read, :count]
+                    self.assertEqual(list(energies), sorted(energies))
+                    for sample, energy in zip(samples, energies):
+                        self.assertAlmostEqual(energy, sample @ Q @ sample)
+                    self.assertEqual(len({tuple(sample) for sample in samples}), count)
+                    self.assertTrue(np.isinf(elites.energies[read, count:]).all())
+
+                # With a work budget, runs are reproducible
+                *_, again = tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, -1, 10**6, **kwargs)
+                np.testing.assert_array_equal(again.samples, elites.samples)
+
+        with self.assertRaises(ValueError):
+            tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, 10, 10, elite_size=1, path_relinking=True)
+
+    def test_revisits(self):
+        Q, init, seeds = self.Q, self.init, self.seeds
+
+        def search(**kwargs):
+            return tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, -1, 10**6, max_evaluations=10**6,
+                                                      **kwargs)
+
+        # Counting revisits leaves the search as it is
+        plain = search()
+        *result, revisits = search(visited_minima=1000)
+        np.testing.assert_array_equal(result[0], plain[0])
+        np.testing.assert_array_equal(result[3], plain[3])
+        self.assertTrue((revisits.minima > 0).all())
+        self.assertTrue((revisits.revisits > 0).all())
+        self.assertTrue((revisits.revisits <= revisits.minima).all())
+        self.assertFalse(revisits.stops.any())
+
+        # Revisits end tabu searches early, reproducibly with a work budget
+        *result, revisits = search(visited_minima=1000, max_revisits=0)
+        self.assertTrue((revisits.stops > 0).all())
+        self.assertTrue((revisits.stops <= revisits.revisits).all())
+        self.assertTrue((result[2] > plain[2]).all())
+        *again, revisits_again = search(visited_minima=1000, max_revisits=0)
+        np.testing.assert_array_equal(again[0], result[0])
+        np.testing.assert_array_equal(revisits_again.stops, revisits.stops)
+
+        self.assertEqual(len(search()), 6)
+        with self.assertRaises(ValueError):
+            search(visited_minima=-1)
+        with self.assertRaises(RuntimeError):
+            search(visited_minima=2**30 + 1)
+
+    def test_problem(self):
+        Q, init = self.Q, self.init[0]
+
+        problem = tabu.tabu_search.Problem(Q)
+        self.assertEqual(problem.num_variables, 30)
+        self.assertEqual(problem.dtype, np.double)
+        self.assertEqual(tabu.tabu_search.Problem(np.asarray(Q, dtype=np.int64)).dtype, np.int32)
+        with self.assertRaises(AttributeError):
+            problem.num_variables = 3
+
+        # A prepared problem gives the same results as the matrix it came from
+        search = tabu.TabuSearch(problem, init, 5, -1, 10, 7)
+        reference = tabu.TabuSearch(Q, init, 5, -1, 10, 7)
+        self.assertEqual(search.bestSolution(), reference.bestSolution())
+
+        samples, energies, *_ = tabu.tabu_search.tabu_search_batch(problem, [init] * 2, [1, 2], 5, -1, 10,
+                                                                   num_threads=2)
+        reference = tabu.tabu_search.tabu_search_batch(Q, [init] * 2, [1, 2], 5, -1, 10)
+        np.testing.assert_array_equal(samples, reference[0])
+        np.testing.assert_array_equal(energies, reference[1])
+
+        with self.assertRaises(RuntimeError):
+            tabu.tabu_search.Problem(np.ones((2, 3)))
+
+    def test_problem_from_vectors(self):
+        Q = self.Q
+        linear, (irow, icol, values), *_ = self.bqm.to_numpy_vectors()
+        init = [[1] * 30, [0] * 30]
+
+        # Full quadratic biases give the same problem as the halved matrix
+        problem = tabu.tabu_search.Problem.from_vectors(linear, irow, icol, values)
+        self.assertEqual(problem.num_variables, 30)
+        self.assertEqual(problem.dtype, np.double)
+        samples, energies, *_ = tabu.tabu_search.tabu_search_batch(problem, init, [1, 2], 5, -1, 10)
+        reference = tabu.tabu_search.tabu_search_batch(Q, init, [1, 2], 5, -1, 10)
+        np.testing.assert_array_equal(samples, reference[0])
+        np.testing.assert_array_equal(energies, reference[1])
+
+        # Couplings listed twice or in either order are summed
+        split = tabu.tabu_search.Problem.from_vectors(linear, np.concatenate([irow, icol]),
+                                                      np.concatenate([icol, irow]),
+                                                      np.concatenate([values, values]) / 2)
+        samples, energies, *_ = tabu.tabu_search.tabu_search_batch(split, init, [1, 2], 5, -1, 10)
+        np.testing.assert_array_equal(samples, reference[0])
+
+        Problem = tabu.tabu_search.Problem
+        self.assertEqual(Problem.from_vectors(linear.astype(np.single), irow, icol,
+                                              values.astype(np.single)).dtype, np.single)
+        self.assertEqual(Problem.from_vectors([1, 2], [0], [1], [3]).dtype, np.int32)
+        self.assertEqual(Problem.from_vectors([2**31 - 2, 0], [0], [1], [3]).dtype, np.int64)
+        self.assertEqual(Problem.from_vectors([], [], [], []).num_variables, 0)
+
+        with self.assertRaises(RuntimeError):
+            Problem.from_vectors([1, 2], [0], [2], [1.])
+        with self.assertRaises(RuntimeError):
+            Problem.from_vectors([1, 2], [1], [1], [1.])
+        with self.assertRaises(ValueError):
+            Problem.from_vectors([1, 2], [0, 1], [1], [1.])
+
+    def test_run(self):
+        Q, init = self.Q, self.init[0]
+
+        search = tabu.TabuSearch(Q, init, 5, -1, 5, 7)
+        self.assertEqual(search.numRestarts(), 5)
+
+        # Runs go on from the best solution, the statistics accumulate
+        energies = [search.bestEnergy()]
+        for restarts in [10, 15, 20]:
+            iterations = search.numIterations()
+            search.run(-1, 5)
+            energies.append(search.bestEnergy())
+            self.assertEqual(search.numRestarts(), restarts)
+            self.assertGreater(search.numIterations(), iterations)
+            x = np.array(search.bestSolution())
+            self.assertAlmostEqual(x @ np.asarray(Q) @ x, search.bestEnergy())
+        self.assertEqual(energies, sorted(energies, reverse=True))
+
+        # Sessions are deterministic
+        again = tabu.TabuSearch(Q, init, 5, -1, 5, 7)
+        for _ in range(3):
+            again.run(-1, 5)
+        self.assertEqual(again.bestSolution(), search.bestSolution())
+        self.assertEqual(again.numIterations(), search.numIterations())
+
+        # The evaluation budget is per run
+        evaluations = search.numEvaluations()
+        search.run(-1, 10**6, None, 1, 10**5)
+        self.assertGreaterEqual(search.numEvaluations() - evaluations, 10**5)
+        self.assertLess(search.numEvaluations() - evaluations, 2 * 10**5)
+
+        with self.assertRaises(RuntimeError):
+            search.run(-1, 5, None, 0)
+
+    def test_many(self):
+        bqms = [dimod.generators.random.randint(n, 'BINARY', seed=n) for n in (5, 12, 1, 8)]
+        vectors = [bqm.to_numpy_vectors() for bqm in bqms]
+        num_vars = [len(v[0]) for v in vectors]
+        offsets = np.cumsum([0] + [len(v[1][2]) for v in vectors])
+        linear = np.concatenate([v[0] for v in vectors])
+        irow, icol, values = (np.concatenate([v[1][k] for v in vectors]) for k in range(3))
+
+        rng = np.random.default_rng(3)
+        init = rng.integers(2, size=2 * len(linear), dtype=np.int8)
+        seeds = rng.integers(2**32, size=2 * len(bqms), dtype=np.uint32)
+
+        samples, energies = tabu.tabu_search.tabu_search_many(num_vars, linear, offsets, irow, icol, values,
+                                                              init, seeds, 0, -1, 10, num_threads=3)
+        self.assertEqual(samples.shape, init.shape)
+        self.assertEqual(energies.shape, (8,))
+
+        # Each problem gives the same results as when searched on its own
+        start = 0
+        for k, bqm in enumerate(bqms):
+            n = num_vars[k]
+            Q, _ = tabu.TabuSampler._bqm_to_tabu_qubo(bqm)
+            reference = tabu.tabu_search.tabu_search_batch(Q, init[start:start + 2 * n].reshape(2, n),
+                                                           seeds[2 * k:2 * k + 2], min(20, n // 4), -1, 10)
+            np.testing.assert_array_equal(samples[start:start + 2 * n].reshape(2, n), reference[0])
+            np.testing.assert_array_equal(energies[2 * k:2 * k + 2], reference[1])
+            start += 2 * n
+
+        empty = tabu.tabu_search.tabu_search_many([], [], [0], [], [], [], [], [], 0, -1, 10)
+        self.assertEqual(len(empty[1]), 0)
+
+        with self.assertRaises(ValueError):
+            tabu.tabu_search.tabu_search_many(num_vars, linear, offsets, irow, icol, values,
+                                              init[1:], seeds, 0, -1, 10)
+        with self.assertRaises(RuntimeError):
+            tabu.tabu_search.tabu_search_many([2], [0, 0], [0, 1], [0], [2], [1.], [0, 0], [1], 0, -1, 10)
+
+    def test_phase_times(self):
+        Q, init, seeds = self.Q, self.init[:2], self.seeds[:2]
+        search = tabu.TabuSearch(Q, init[0], 5, -1, 10, 7)
+        *_, phases = tabu.tabu_search.tabu_search_batch(Q, init, seeds, 5, -1, 10)
+
+        if not tabu.tabu_search.PHASE_TIMING:
+            self.assertEqual(search.phaseTimes(), {})
+            self.assertEqual(phases, {})
+            return
+
+        for times, reads in [(search.phaseTimes(), 1), (phases, 2)]:
+            self.assertEqual(set(times), {'construct', 'initialize', 'compute_c', 'select_variables',
+                                          'steepest_ascent', 'tabu_loop', 'local_search', 'path_relink'})
+            self.assertTrue(all(t.seconds >= 0 for t in times.values()))
+            # The problem is built once, the first tabu search runs before the restarts
+            self.assertEqual(times['construct'].calls, 1)
+            self.assertEqual(times['tabu_loop'].calls, reads * 11)
+            self.assertEqual(times['steepest_ascent'].calls, reads * 10)
+
     def test_float(self):
         n = 20
         init = [1] * n
@@ -90,6 +484,51 @@ class TestTabuSearch(unittest.TestCase):
         search = tabu.TabuSearch(Q, init, tenure, timeout, restarts)
         self.assertAlmostEqual(search.bestEnergy(), -14.65986790)
 
+    def test_buffer_layouts(self):
+        qubo = np.array([[-1.2, 1.1], [1.1, -1.2]])
+        init = [1, 1]
+        tenure = len(init) - 1
+        timeout = 20
+        restarts = 100
+
+        # Q is read in place from float64 and float32 arrays of any strides
+        for Q in [qubo, np.asfortranarray(qubo), np.repeat(qubo, 2, axis=1)[:, ::2],
+                  qubo.astype(np.float32), qubo.astype(int) + 1]:
+            with self.subTest(dtype=Q.dtype, strides=Q.strides):
+                search = tabu.TabuSearch(Q, init, tenure, timeout, restarts)
+                expected = min(Q[0, 0], Q[1, 1], Q.sum(), 0)
+                self.assertAlmostEqual(search.bestEnergy(), expected, places=6)
+
+    def test_coefficient_types(self):
+        rng = np.random.default_rng(2022)
+        n = 30
+        qubo = np.triu(rng.integers(-50, 50, size=(n, n)))
+        qubo = qubo + qubo.T
+        init = [1] * n
+        tenure = 5
+
+        # Searches that do the same work find the same solution in every coefficient type
+        results = []
+        for dtype in [np.double, np.float32, np.int32, np.int64, np.int16]:
+            with self.subTest(dtype=dtype):
+                search = tabu.TabuSearch(qubo.astype(dtype), init, tenure, -1, 10**6, 7, None, 1, 10**6)
+                results.append((search.bestEnergy(), list(search.bestSolution()), search.numRestarts()))
+        self.assertEqual(results.count(results[0]), len(results))
+
+        samples, energies, _, _, _, _ = tabu.tabu_search.tabu_search_batch(qubo.astype(np.int32), [init], [7], tenure,
+                                                                           -1, 10**6, max_evaluations=10**6)
+        self.assertEqual(energies[0], results[0][0])
+        self.assertEqual(list(samples[0]), results[0][1])
+
+        # Integer problems are searched in int32 unless a change in objective may overflow it
+        self.assertEqual(tabu.tabu_search.as_qubo(qubo).dtype, np.int32)
+        self.assertEqual(tabu.tabu_search.as_qubo(qubo * 2**24).dtype, np.int64)
+        self.assertEqual(tabu.tabu_search.as_qubo(qubo.astype(bool)).dtype, np.double)
+
+        large = np.array([[2**40, 2**39], [2**39, -2**41]])
+        search = tabu.TabuSearch(large, [0, 0], 1, -1, 10)
+        self.assertEqual(search.bestEnergy(), -2**41)
+
     def test_exceptions(self):
         qubo = [[-1.2, 1.1], [1.1, -1.2]]
         timeout = 10
@@ -101,6 +540,12 @@ class TestTabuSearch(unittest.TestCase):
             tenure = len(init) - 1
             search = tabu.TabuSearch(qubo, init, tenure, timeout, restarts)
 
+        # Q not square
+        with self.assertRaises(RuntimeError):
+            init = [1, 1]
+            tenure = len(init) - 1
+            search = tabu.TabuSearch(np.ones((2, 3)), init, tenure, timeout, restarts)
+
         # Tenure out of bounds
         with self.assertRaises(RuntimeError):
             init = [1, 1]
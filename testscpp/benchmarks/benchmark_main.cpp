@@ -0,0 +1,188 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+/*
+Microbenchmarks of the phases of the search on synthetic problems, written as JSON.
+
+>>> make benchmark
+>>> ./benchmark_main --max-size 10000 --seconds 0.5 --out results.json
+
+--max-size: Largest number of variables to run (default 100000)
+--seconds: Time spent on each measurement (default 0.5)
+--out: Output file (default standard output)
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "generators.h"
+#include "kernels.h"
+#include "tabu_search.h"
+
+using std::vector;
+
+namespace {
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calls f for about the given number of seconds, at least once, and returns
+// the mean time of a call in microseconds. setup runs untimed before each call.
+double timeCalls(double seconds, const std::function<void()> &f,
+                 const std::function<void()> &setup = []() {}) {
+    double spent = 0;
+    long long calls = 0;
+    do {
+        setup();
+        double start = now();
+        f();
+        spent += now() - start;
+        calls++;
+    } while (spent < seconds);
+    return spent * 1e6 / calls;
+}
+
+struct Result {
+    std::string generator;
+    int size;
+    long long couplings;
+    bool dense;
+    double constructMs;
+    double objectiveUs;
+    double flipsPerSecond;
+    double computeCDiagonalUs;
+    double selectVariablesUs;
+    double steepestAscentUs;
+};
+
+}
+
+class TabuSearchBenchmark
+{
+    public:
+        static Result run(const Problem &problem, double seconds) {
+            Result result;
+            result.generator = problem.family;
+            result.size = problem.nVars;
+            result.couplings = problem.couplings.size();
+
+            std::shared_ptr<const BQP<double>> bqp;
+            result.constructMs = timeCalls(seconds, [&]() { bqp = makeBQP(problem); }) / 1e3;
+            result.dense = bqp->dense;
+
+            int n = bqp->nVars;
+            std::default_random_engine generator(1);
+            BitVector solution(n);
+            for (int i = 0; i < n; i++) {
+                solution.set(i, generator() & 1);
+            }
+
+            double objective = 0;
+            result.objectiveUs = timeCalls(seconds, [&]() { objective = bqp->getObjective(solution); });
+
+            // Tabu search from the random solution, with an iteration limit it does not reach
+            TabuSearch<double> search(bqp, 20, 1);
+            double start = now();
+            search.simpleTabuSearch(solution, objective, 1000000, (long long)(seconds * 1000), true,
+                                    -std::numeric_limits<double>::max(), nullptr);
+            result.flipsPerSecond = search.state.iterNum / (now() - start);
+
+            // Restart phases, from the local minimum found above
+            int numSelection = (10 > (int)(ALPHA * n))? 10 : (int)(ALPHA * n);
+            if (numSelection > n) {
+                numSelection = n;
+            }
+            vector<double> diagonal(n);
+            vector<int> I(n);
+            BitVector selected(n);
+            result.computeCDiagonalUs = timeCalls(seconds, [&]() {
+                search.computeCDiagonal(diagonal, search.state.solution);
+            });
+            result.selectVariablesUs = timeCalls(seconds, [&]() {
+                search.selectVariables(numSelection, diagonal, I);
+            });
+            result.steepestAscentUs = timeCalls(seconds, [&]() {
+                search.steepestAscent(numSelection, diagonal, I, selected);
+            }, [&]() { selected.reset(); });
+            return result;
+        }
+};
+
+int main(int argc, char *argv[]) {
+    int maxSize = 100000;
+    double seconds = 0.5;
+    const char *out = nullptr;
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--max-size") && a + 1 < argc) {
+            maxSize = atoi(argv[++a]);
+        }
+        else if (!strcmp(argv[a], "--seconds") && a + 1 < argc) {
+            seconds = atof(argv[++a]);
+        }
+        else if (!strcmp(argv[a], "--out") && a + 1 < argc) {
+            out = argv[++a];
+        }
+        else {
+            fprintf(stderr, "usage: %s [--max-size N] [--seconds S] [--out FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    vector<std::function<Problem()>> problems;
+    for (int n : {100, 1000, 5000}) {
+        if (n <= maxSize) problems.push_back([n]() { return denseRandom(n, 1); });
+    }
+    for (int n : {100, 1000, 10000, 100000}) {
+        if (n <= maxSize) problems.push_back([n]() { return sparseRandom(n, 10, 1); });
+        if (n <= maxSize) problems.push_back([n]() { return maxCut(n, 6, 1); });
+    }
+    // 8 * cells * cells variables, about 100 to 100000
+    for (int cells : {4, 12, 35, 111}) {
+        if (8 * cells * cells <= maxSize) problems.push_back([cells]() { return chimera(cells, 1); });
+        if (8 * cells * cells <= maxSize) problems.push_back([cells]() { return pegasusLike(cells, 1); });
+    }
+
+    FILE *file = out? fopen(out, "w") : stdout;
+    if (file == nullptr) {
+        perror(out);
+        return 1;
+    }
+    fprintf(file, "{\n  \"instruction_set\": \"%s\",\n  \"results\": [", kernelInstructionSet());
+    for (size_t p = 0; p < problems.size(); p++) {
+        Result r = TabuSearchBenchmark::run(problems[p](), seconds);
+        fprintf(file, "%s\n    {\"generator\": \"%s\", \"size\": %d, \"couplings\": %lld, \"dense\": %s, "
+                "\"construct_ms\": %.4f, \"objective_us\": %.3f, \"flips_per_second\": %.1f, "
+                "\"compute_c_diagonal_us\": %.3f, \"select_variables_us\": %.3f, \"steepest_ascent_us\": %.3f}",
+                p? "," : "", r.generator.c_str(), r.size, r.couplings, r.dense? "true" : "false",
+                r.constructMs, r.objectiveUs, r.flipsPerSecond,
+                r.computeCDiagonalUs, r.selectVariablesUs, r.steepestAscentUs);
+        fflush(file);
+        if (out) {
+            fprintf(stderr, "%s %d done\n", r.generator.c_str(), r.size);
+        }
+    }
+    fprintf(file, "\n  ]\n}\n");
+    if (out) {
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "generators.h"
+
+#include <algorithm>
+#include <random>
+
+using std::vector;
+
+namespace {
+
+// Sorts the couplings of a problem and drops repeated pairs and self loops
+void removeDuplicates(Problem &problem) {
+    vector<Problem::Coupling> &c = problem.couplings;
+    for (Problem::Coupling &coupling : c) {
+        if (coupling.i > coupling.j) {
+            std::swap(coupling.i, coupling.j);
+        }
+    }
+    std::sort(c.begin(), c.end(), [](const Problem::Coupling &a, const Problem::Coupling &b) {
+        return (a.i != b.i)? a.i < b.i : a.j < b.j;
+    });
+    c.erase(std::unique(c.begin(), c.end(), [](const Problem::Coupling &a, const Problem::Coupling &b) {
+        return a.i == b.i && a.j == b.j;
+    }), c.end());
+    c.erase(std::remove_if(c.begin(), c.end(), [](const Problem::Coupling &a) {
+        return a.i == a.j;
+    }), c.end());
+}
+
+// Index of qubit k of the vertical (side 0) or horizontal (side 1) half of cell (r, c)
+int qubit(int cells, int r, int c, int side, int k) {
+    return ((r * cells + c) * 2 + side) * 4 + k;
+}
+
+Problem lattice(const char *family, int cells, bool pegasus, unsigned int seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> sign(0, 1);
+    Problem problem{family, 8 * cells * cells, vector<double>(8 * cells * cells, 0), {}};
+
+    auto couple = [&](int i, int j) {
+        problem.couplings.push_back({i, j, sign(generator)? 1.0 : -1.0});
+    };
+    for (int r = 0; r < cells; r++) {
+        for (int c = 0; c < cells; c++) {
+            for (int k = 0; k < 4; k++) {
+                for (int l = 0; l < 4; l++) {
+                    couple(qubit(cells, r, c, 0, k), qubit(cells, r, c, 1, l));
+                    if (pegasus && r + 1 < cells && c + 1 < cells) {
+                        couple(qubit(cells, r, c, 0, k), qubit(cells, r + 1, c + 1, 1, l));
+                    }
+                }
+                for (int step = 1; step <= (pegasus? 2 : 1); step++) {
+                    if (r + step < cells) {
+                        couple(qubit(cells, r, c, 0, k), qubit(cells, r + step, c, 0, k));
+                    }
+                    if (c + step < cells) {
+                        couple(qubit(cells, r, c, 1, k), qubit(cells, r, c + step, 1, k));
+                    }
+                }
+            }
+            if (pegasus) {
+                for (int side = 0; side < 2; side++) {
+                    couple(qubit(cells, r, c, side, 0), qubit(cells, r, c, side, 1));
+                    couple(qubit(cells, r, c, side, 2), qubit(cells, r, c, side, 3));
+                }
+            }
+        }
+    }
+    return problem;
+}
+
+}
+
+Problem denseRandom(int n, unsigned int seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> value(-100, 100);
+    Problem problem{"dense", n, vector<double>(n), {}};
+    problem.couplings.reserve((size_t)n * (n - 1) / 2);
+    for (int i = 0; i < n; i++) {
+        problem.linear[i] = value(generator);
+        for (int j = i + 1; j < n; j++) {
+            int v = value(generator);
+            problem.couplings.push_back({i, j, (double)(v? v : 1)});   // Keep every pair coupled
+        }
+    }
+    return problem;
+}
+
+Problem sparseRandom(int n, int degree, unsigned int seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> value(-100, 100);
+    std::uniform_int_distribution<int> variable(0, n - 1);
+    Problem problem{"sparse", n, vector<double>(n), {}};
+    for (int i = 0; i < n; i++) {
+        problem.linear[i] = value(generator);
+    }
+    for (long long e = 0; e < (long long)n * degree / 2; e++) {
+        problem.couplings.push_back({variable(generator), variable(generator), (double)value(generator)});
+    }
+    removeDuplicates(problem);
+    return problem;
+}
+
+Problem chimera(int cells, unsigned int seed) {
+    return lattice("chimera", cells, false, seed);
+}
+
+Problem pegasusLike(int cells, unsigned int seed) {
+    Problem problem = lattice("pegasus", cells, true, seed);
+    removeDuplicates(problem);
+    return problem;
+}
+
+Problem maxCut(int n, int degree, unsigned int seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> sign(0, 1);
+    std::uniform_int_distribution<int> variable(0, n - 1);
+    Problem problem{"maxcut", n, vector<double>(n, 0), {}};
+    for (long long e = 0; e < (long long)n * degree / 2; e++) {
+        problem.couplings.push_back({variable(generator), variable(generator), sign(generator)? 1.0 : -1.0});
+    }
+    removeDuplicates(problem);
+
+    // Edge (i, j) of weight w adds w * (x_i + x_j - 2 x_i x_j) to the cut
+    for (Problem::Coupling &edge : problem.couplings) {
+        problem.linear[edge.i] -= edge.value;
+        problem.linear[edge.j] -= edge.value;
+        edge.value *= 2;
+    }
+    return problem;
+}
+
+std::shared_ptr<const BQP<double>> makeBQP(const Problem &problem) {
+    size_t m = problem.couplings.size();
+    vector<int> irow(m), icol(m);
+    vector<double> values(m);
+    for (size_t k = 0; k < m; k++) {
+        irow[k] = problem.couplings[k].i;
+        icol[k] = problem.couplings[k].j;
+        values[k] = problem.couplings[k].value;
+    }
+    return std::make_shared<const BQP<double>>(problem.nVars, problem.linear.data(), m, irow.data(), icol.data(),
+                                               values.data());
+}
@@ -0,0 +1,98 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#ifndef _GENERATORS_H_
+
+#define _GENERATORS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bqp.h"
+
+/**
+ * A synthetic QUBO, as its linear biases and its couplings Q[i][j] + Q[j][i]
+ * for i < j, each pair listed once
+ */
+struct Problem {
+    struct Coupling {
+        int i;
+        int j;
+        double value;
+    };
+
+    std::string family;
+    int nVars;
+    std::vector<double> linear;
+    std::vector<Coupling> couplings;
+};
+
+/**
+ * Fully connected problem with integer biases and couplings in [-100, 100]
+ * @param n: Number of variables
+ * @param seed: RNG seed
+ * @return Problem
+ */
+Problem denseRandom(int n, unsigned int seed);
+
+/**
+ * Erdos-Renyi style problem with about n * degree / 2 couplings, integer
+ * biases and couplings in [-100, 100]
+ * @param n: Number of variables
+ * @param degree: Average number of neighbors of a variable
+ * @param seed: RNG seed
+ * @return Problem
+ */
+Problem sparseRandom(int n, int degree, unsigned int seed);
+
+/**
+ * Chimera-like lattice: a cells x cells grid of K4,4 unit cells, whose
+ * vertical and horizontal qubits couple to the same qubits of the next cell
+ * down and right (degree 6), with couplings in {-1, 1} and no linear biases
+ * @param cells: Grid size, the problem has 8 * cells * cells variables
+ * @param seed: RNG seed
+ * @return Problem
+ */
+Problem chimera(int cells, unsigned int seed);
+
+/**
+ * Pegasus-like lattice: the Chimera-like lattice above plus odd couplers
+ * between qubit pairs of a cell and couplers to the diagonal next cell,
+ * and to the second next cell in line (degree 13, against 15 in Pegasus)
+ * @param cells: Grid size, the problem has 8 * cells * cells variables
+ * @param seed: RNG seed
+ * @return Problem
+ */
+Problem pegasusLike(int cells, unsigned int seed);
+
+/**
+ * Gset-style max-cut: a random graph with edge weights in {-1, 1}, written
+ * as the QUBO minimizing minus the weight of the cut
+ * @param n: Number of vertices
+ * @param degree: Average degree
+ * @param seed: RNG seed
+ * @return Problem
+ */
+Problem maxCut(int n, int degree, unsigned int seed);
+
+/**
+ * Builds the BQP of a problem with the constructor from a list of
+ * couplings, so the layout is the one the library picks.
+ * @param problem: Problem
+ * @return BQP
+ */
+std::shared_ptr<const BQP<double>> makeBQP(const Problem &problem);
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2022 D-Wave Systems Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tabu_c.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static void test_dense(void) {
+    /* Minimum -4 at x = (1, 1, 0) */
+    const double Q[9] = {-1, -1, 0,
+                         -1, -1, 2,
+                          0,  2, 1};
+    tabu_problem *problem = NULL;
+    tabu_result *result = NULL;
+    tabu_options options;
+    tabu_error error;
+    int read;
+
+    CHECK(tabu_problem_create_dense(Q, 3, &problem, &error) == TABU_OK);
+    CHECK(tabu_problem_num_variables(problem) == 3);
+
+    tabu_options_init(&options);
+    options.num_reads = 4;
+    options.timeout = -1;
+    options.num_restarts = 5;
+    options.seed = 7;
+    CHECK(tabu_solve(problem, &options, &result, &error) == TABU_OK);
+    CHECK(tabu_result_num_reads(result) == 4);
+    CHECK(tabu_result_num_variables(result) == 3);
+    for (read = 0; read < 4; read++) {
+        const int8_t *sample = tabu_result_sample(result, read);
+        CHECK(tabu_result_energy(result, read) == -4);
+        CHECK(sample[0] == 1 && sample[1] == 1 && sample[2] == 0);
+        CHECK(tabu_result_num_iterations(result, read) > 0);
+        CHECK(tabu_result_num_evaluations(result, read) > 0);
+    }
+
+    /* The problem outlives none of its results */
+    tabu_problem_free(problem);
+    CHECK(tabu_result_energy(result, 0) == -4);
+    tabu_result_free(result);
+}
+
+static void test_sparse(void) {
+    /* The same problem as test_dense, from its biases */
+    const double linear[3] = {-1, -1, 1};
+    const int irow[2] = {0, 1};
+    const int icol[2] = {1, 2};
+    const double values[2] = {-2, 4};
+    tabu_problem *problem = NULL;
+    tabu_result *result = NULL;
+
+    CHECK(tabu_problem_create_sparse(3, linear, 2, irow, icol, values, &problem, NULL) == TABU_OK);
+    CHECK(tabu_solve(problem, NULL, &result, NULL) == TABU_OK);
+    CHECK(tabu_result_num_reads(result) == 1);
+    CHECK(tabu_result_energy(result, 0) == -4);
+    tabu_result_free(result);
+    tabu_problem_free(problem);
+}
+
+static void test_stopping(void) {
+    const double Q[9] = {-1, -1, 0,
+                         -1, -1, 2,
+                          0,  2, 1};
+    const int8_t ones[9] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+    tabu_problem *problem = NULL;
+    tabu_result *result = NULL;
+    tabu_cancellation *cancellation = tabu_cancellation_create();
+    tabu_options options;
+    int read;
+
+    CHECK(cancellation != NULL);
+    CHECK(tabu_problem_create_dense(Q, 3, &problem, NULL) == TABU_OK);
+
+    /* A cancelled token stops reads that would otherwise never end */
+    tabu_options_init(&options);
+    options.num_reads = 3;
+    options.timeout = -1;
+    options.num_restarts = 2000000000;
+    options.initial_states = ones;
+    options.cancellation = cancellation;
+    tabu_cancellation_cancel(cancellation);
+    CHECK(tabu_solve(problem, &options, &result, NULL) == TABU_OK);
+    for (read = 0; read < 3; read++) {
+        CHECK(tabu_result_energy(result, read) == 1);
+        CHECK(tabu_result_num_iterations(result, read) == 0);
+        CHECK(tabu_result_num_evaluations(result, read) == 0);
+    }
+    tabu_result_free(result);
+
+    /* So does the total time limit */
+    options.cancellation = NULL;
+    options.total_timeout = 20;
+    CHECK(tabu_solve(problem, &options, &result, NULL) == TABU_OK);
+    tabu_result_free(result);
+
+    /* The first read meeting the threshold stops the others, which run after it on one thread */
+    options.total_timeout = -1;
+    options.use_energy_threshold = 1;
+    options.energy_threshold = -4;
+    options.stop_all_on_threshold = 1;
+    CHECK(tabu_solve(problem, &options, &result, NULL) == TABU_OK);
+    CHECK(tabu_result_energy(result, 0) == -4);
+    CHECK(tabu_result_num_evaluations(result, 1) == 0);
+    CHECK(tabu_result_num_evaluations(result, 2) == 0);
+    tabu_result_free(result);
+
+    tabu_problem_free(problem);
+    tabu_cancellation_free(cancellation);
+}
+
+static void test_options_size(void) {
+    const double Q[1] = {-1};
+    const int8_t zero[2] = {0, 0};
+    tabu_problem *problem = NULL;
+    tabu_result *result = NULL;
+    tabu_cancellation *cancellation = tabu_cancellation_create();
+    tabu_options options;
+    tabu_error error;
+
+    CHECK(tabu_problem_create_dense(Q, 1, &problem, NULL) == TABU_OK);
+
+    tabu_options_init(&options);
+    CHECK(options.struct_size == sizeof(tabu_options));
+
+    /* A caller built before the cancellation option gets the default for it and later options */
+    tabu_options_init_size(&options, offsetof(tabu_options, cancellation));
+    CHECK(options.struct_size == offsetof(tabu_options, cancellation));
+    CHECK(options.num_reads == 1);
+    options.num_reads = 2;
+    options.initial_states = zero;
+    options.cancellation = cancellation;
+    tabu_cancellation_cancel(cancellation);
+    CHECK(tabu_solve(problem, &options, &result, NULL) == TABU_OK);
+    CHECK(tabu_result_num_reads(result) == 2);
+    CHECK(tabu_result_energy(result, 1) == -1);
+    tabu_result_free(result);
+
+    /* Uninitialized options */
+    options.struct_size = 0;
+    CHECK(tabu_solve(problem, &options, &result, &error) == TABU_ERROR_INVALID_ARGUMENT);
+    CHECK(strstr(error.message, "struct_size") != NULL);
+
+    tabu_problem_free(problem);
+    tabu_cancellation_free(cancellation);
+}
+
+static void test_errors(void) {
+    const double asymmetric[4] = {1, -2, 0, 1};
+    const int irow[1] = {0};
+    const int icol[1] = {0};
+    const double values[1] = {1};
+    tabu_problem *problem = NULL;
+    tabu_result *result = NULL;
+    tabu_options options;
+    tabu_error error;
+
+    CHECK(tabu_problem_create_dense(asymmetric, 2, &problem, &error) == TABU_ERROR_INVALID_ARGUMENT);
+    CHECK(strcmp(error.message, "Q must be symmetric") == 0);
+    CHECK(problem == NULL);
+
+    CHECK(tabu_problem_create_sparse(1, values, 1, irow, icol, values, &problem, &error) ==
+          TABU_ERROR_INVALID_ARGUMENT);
+    CHECK(tabu_problem_load("no/such/file", &problem, &error) == TABU_ERROR_IO);
+    CHECK(strstr(error.message, "cannot open problem file") != NULL);
+    CHECK(tabu_solve(NULL, NULL, &result, NULL) == TABU_ERROR_INVALID_ARGUMENT);
+
+    CHECK(tabu_problem_create_dense(asymmetric, 1, &problem, &error) == TABU_OK);
+    tabu_options_init(&options);
+    options.tenure = 5;
+    CHECK(tabu_solve(problem, &options, &result, &error) == TABU_ERROR_INVALID_ARGUMENT);
+    CHECK(strstr(error.message, "tenure") != NULL);
+    tabu_problem_free(problem);
+
+    tabu_problem_free(NULL);
+    tabu_result_free(NULL);
+}
+
+int main(void) {
+    test_dense();
+    test_sparse();
+    test_stopping();
+    test_options_size();
+    test_errors();
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+#include "bit_vector.h"
+
+using std::vector;
+
+TEST_CASE("Test BitVector against an unpacked solution") {
+    std::default_random_engine generator(2022);
+    std::uniform_int_distribution<int> bit(0, 1);
+
+    // Sizes around word boundaries
+    for (int n : {0, 1, 63, 64, 65, 130}) {
+        vector<int> a(n), b(n);
+        for (int i = 0; i < n; i++) {
+            a[i] = bit(generator);
+            b[i] = bit(generator);
+        }
+        BitVector packedA(a), packedB(b);
+        REQUIRE(packedA.size() == n);
+        REQUIRE(packedA.numWords() == (n + 63) / 64);
+        REQUIRE(packedA.toVector() == a);
+
+        int ones = 0, differ = 0;
+        vector<int> set;
+        for (int i = 0; i < n; i++) {
+            ones += a[i];
+            differ += a[i] != b[i];
+            if (a[i]) {
+                set.push_back(i);
+            }
+        }
+        REQUIRE(packedA.count() == ones);
+        REQUIRE(packedA.distance(packedB) == differ);
+
+        vector<int> visited;
+        packedA.forEachSet([&](int i) { visited.push_back(i); });
+        REQUIRE(visited == set);
+
+        // Flipping every differing variable of b turns it into a
+        for (int i = 0; i < n; i++) {
+            if (a[i] != b[i]) {
+                packedB.flip(i);
+            }
+        }
+        REQUIRE(packedB == packedA);
+
+        packedA.reset();
+        REQUIRE(packedA == BitVector(n));
+        REQUIRE(packedA.count() == 0);
+    }
+
+    BitVector x(70);
+    x.set(69, 1);
+    x.set(3, 1);
+    x.set(3, 0);
+    REQUIRE(x[69] == 1);
+    REQUIRE(x[3] == 0);
+    REQUIRE(x.data()[1] == (std::uint64_t(1) << 5));
+}
@@ -14,6 +14,8 @@
 
 #include "../Catch2/single_include/catch2/catch.hpp"
 
+#include <cstdint>
+#include <random>
 #include <vector>
 
 #include "bqp.cpp"
@@ -26,61 +28,212 @@ TEST_CASE("Test constructor") {
                                    {0, 1}};
 
     REQUIRE_THROWS_WITH([&]() {
-        BQP bqp = BQP(bad_Q);
+        BQP<double> bqp = BQP<double>(bad_Q);
     }(), Contains("Q must be symmetric"));
 
     bad_Q = {{1,-2},
              {-2, 1, 0}};
 
     REQUIRE_THROWS_WITH([&]() {
-        BQP bqp = BQP(bad_Q);
+        BQP<double> bqp = BQP<double>(bad_Q);
     }(), Contains("Q must be a symmetric square matrix"));   
 }
 
-TEST_CASE("Test BQP::initialize()") {
+TEST_CASE("Test constructor from a strided buffer") {
+    vector<vector<double> > Q {{2,1,0},
+                               {1,2,-1},
+                               {0,-1,2}};
+    BQP<float> expected = BQP<float>(Q);
+
+    // Row-major and column-major layouts of the same matrix
+    vector<float> rowMajor {2,1,0, 1,2,-1, 0,-1,2};
+    BQP<float> fromRows = BQP<float>(rowMajor.data(), 3, 3, 3, 1);
+    BQP<float> fromCols = BQP<float>(rowMajor.data(), 3, 3, 1, 3);
+
+    for (BQP<float> *bqp : {&fromRows, &fromCols}) {
+        REQUIRE(bqp->nVars == 3);
+        REQUIRE(bqp->dense == expected.dense);
+        REQUIRE(bqp->linear == expected.linear);
+        REQUIRE(bqp->offsets == expected.offsets);
+        REQUIRE(bqp->neighbors == expected.neighbors);
+        REQUIRE(bqp->couplings == expected.couplings);
+    }
+
+    vector<double> bad {1,-2, 0,1};
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<double> bqp = BQP<double>(bad.data(), 2, 2, 2, 1);
+    }(), Contains("Q must be symmetric"));
+
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<double> bqp = BQP<double>(bad.data(), 2, 1, 1, 1);
+    }(), Contains("Q must be a symmetric square matrix"));
+}
+
+TEST_CASE("Test constructor from a list of couplings") {
+    // Sparse and dense (more than half the couplings nonzero) problems
+    for (int density : {5, 80}) {
+        std::default_random_engine generator(density);
+        std::uniform_int_distribution<int> value(-4, 4);
+        int n = 30;
+        vector<vector<double> > Q(n, vector<double>(n, 0));
+        vector<double> linear(n);
+        vector<int> irow, icol;
+        vector<double> values;
+        for (int i = 0; i < n; i++) {
+            Q[i][i] = linear[i] = value(generator);
+            for (int j = i + 1; j < n; j++) {
+                if ((int)(generator() % 100) < density) {
+                    // Split over two entries, one of them reversed
+                    double a = value(generator);
+                    double b = value(generator);
+                    irow.insert(irow.end(), {i, j});
+                    icol.insert(icol.end(), {j, i});
+                    values.insert(values.end(), {a, b});
+                    Q[i][j] = Q[j][i] = (a + b) / 2;
+                }
+            }
+        }
+        BQP<double> expected = BQP<double>(Q);
+        BQP<double> bqp = BQP<double>(n, linear.data(), values.size(), irow.data(), icol.data(), values.data());
+
+        REQUIRE(bqp.nVars == n);
+        REQUIRE(bqp.dense == (density > 50));
+        REQUIRE(bqp.dense == expected.dense);
+        REQUIRE(bqp.linear == expected.linear);
+        REQUIRE(bqp.offsets == expected.offsets);
+        REQUIRE(bqp.neighbors == expected.neighbors);
+        REQUIRE(bqp.couplings == expected.couplings);
+    }
+
+    vector<std::int32_t> linear {1, 2};
+    vector<int> irow {0};
+    vector<int> icol {0};
+    vector<std::int32_t> values {1};
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<std::int32_t> bqp = BQP<std::int32_t>(2, linear.data(), 1, irow.data(), icol.data(), values.data());
+    }(), Contains("couplings must join two distinct variables in range"));
+    icol = {2};
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<std::int32_t> bqp = BQP<std::int32_t>(2, linear.data(), 1, irow.data(), icol.data(), values.data());
+    }(), Contains("couplings must join two distinct variables in range"));
+
+    // The change in objective of flipping variable 0 would be 2^31
+    icol = {1};
+    linear = {1 << 30, 0};
+    values = {1 << 30};
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<std::int32_t> bqp = BQP<std::int32_t>(2, linear.data(), 1, irow.data(), icol.data(), values.data());
+    }(), Contains("Q has coefficients too large for its integer type"));
+
+    // No couplings at all
+    BQP<float> empty = BQP<float>(0, (const float *)nullptr, 0, nullptr, nullptr, nullptr);
+    REQUIRE(empty.nVars == 0);
+}
+
+TEST_CASE("Test dense layout") {
     vector<vector<double> > Q {{2,1,1},
                                {1,2,1},
                                {1,1,2}};
 
-    BQP bqp = BQP(Q);
-
-    vector<int> solution = {1, 1, 1};
-    bqp.initialize(solution);
+    BQP<double> bqp = BQP<double>(Q);
 
-    // Check that Q matrix was converted to upper triangular
+    // Check that every coupling is stored in both rows as Q[i][j] + Q[j][i]
+    REQUIRE(bqp.dense);
     for (int i = 0; i < bqp.nVars; i++) {
-        for (int j = i + 1; j < bqp.nVars; j++) {
-            REQUIRE(bqp.Q[i][j] == Q[i][j] + Q[j][i]);
-            REQUIRE(bqp.Q[j][i] == 0);
+        REQUIRE(bqp.linear[i] == Q[i][i]);
+
+        BQPRow<double> row = bqp.row(i);
+        REQUIRE(row.index == nullptr);
+        REQUIRE(row.size == bqp.nVars);
+        REQUIRE((std::uintptr_t)row.value % 64 == 0);
+        for (int j = 0; j < bqp.nVars; j++) {
+            REQUIRE(row.value[j] == ((j == i)? 0 : Q[i][j] + Q[j][i]));
         }
     }
-    
-    // Check that solution was set
-    REQUIRE(bqp.solution == solution);
-    REQUIRE(bqp.solutionQuality == 12);
-    REQUIRE(bqp.nIterations == 1);
+
+    BitVector solution(vector<int> {1, 1, 1});
+    REQUIRE(bqp.getObjective(solution) == 12);
 }
 
 TEST_CASE("Testing BQP::getObjective() and BQP::getChangeInObjective()") {
     vector<vector<double>> Q = {{1, -1},
                                 {-1, 1}};    // equality problem
-    BQP bqp = BQP(Q);
+    BQP<double> bqp = BQP<double>(Q);
 
-    vector<int> solution = {0, 0};
+    BitVector solution(vector<int> {0, 0});
     REQUIRE(bqp.getObjective(solution) == 0);
 
-    vector<int> new_solution = {0, 1};
+    BitVector new_solution(vector<int> {0, 1});
     REQUIRE(bqp.getObjective(new_solution) == 1);
 
     REQUIRE(bqp.getChangeInObjective(solution, 1) == 1);
     REQUIRE(bqp.getChangeInObjective(new_solution, 1) == -1);
 }
 
+TEST_CASE("Testing sparse BQP") {
+    vector<vector<double>> Q = {{-1, 0, 0, 1},
+                                {0, 2, 0, 0},
+                                {0, 0, -3, -2},
+                                {1, 0, -2, 1}};
+    BQP<double> bqp = BQP<double>(Q);
+
+    // Zero couplings are not stored
+    REQUIRE(!bqp.dense);
+    REQUIRE(bqp.offsets == vector<int>{0, 1, 1, 2, 4});
+    REQUIRE(bqp.neighbors == vector<int>{3, 3, 0, 2});
+    REQUIRE(vector<double>(bqp.couplings.begin(), bqp.couplings.end()) == vector<double>{2, -4, 2, -4});
+
+    BQPRow<double> row = bqp.row(3);
+    REQUIRE(row.size == 2);
+    REQUIRE(row.index[1] == 2);
+    REQUIRE(row.value[1] == -4);
+
+    BitVector solution(vector<int> {1, 1, 1, 1});
+    REQUIRE(bqp.getObjective(solution) == -3);
+    REQUIRE(bqp.getChangeInObjective(solution, 0) == -1);
+    REQUIRE(bqp.getChangeInObjective(solution, 1) == -2);
+    REQUIRE(bqp.getChangeInObjective(solution, 3) == 1);
+
+    // Every single-bit change agrees with the objective difference
+    BitVector zeros(4);
+    for (int i = 0; i < bqp.nVars; i++) {
+        BitVector flipped = zeros;
+        flipped.set(i, 1);
+        REQUIRE(bqp.getChangeInObjective(zeros, i) == bqp.getObjective(flipped));
+    }
+}
+
 TEST_CASE("Testing BQP::getMaxBQPCoeff()") {
     vector<vector<double> > Q {{2, 3, -1},
                                {3, -2, 1},
                                {-1, 1, 2}};
 
-    BQP bqp = BQP(Q);
+    BQP<double> bqp = BQP<double>(Q);
     REQUIRE(bqp.getMaxBQPCoeff() == 3);  
 }
+
+TEST_CASE("Testing integer coefficients") {
+    vector<vector<double> > Q {{2, 3, -1},
+                               {3, -2, 1},
+                               {-1, 1, 2}};
+    BQP<double> expected = BQP<double>(Q);
+    BQP<std::int32_t> bqp = BQP<std::int32_t>(Q);
+
+    BitVector solution(vector<int> {1, 0, 1});
+    REQUIRE(bqp.getObjective(solution) == expected.getObjective(solution));
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(bqp.getChangeInObjective(solution, i) == expected.getChangeInObjective(solution, i));
+    }
+
+    REQUIRE_THROWS_WITH([]() {
+        BQP<std::int32_t> bqp = BQP<std::int32_t>(vector<vector<double> > {{0.5}});
+    }(), Contains("Q must have integer coefficients"));
+
+    // The change in objective of flipping variable 0 would be 2^31
+    vector<vector<double> > large {{1u << 30, 1u << 29},
+                                   {1u << 29, 0}};
+    REQUIRE_THROWS_WITH([&]() {
+        BQP<std::int32_t> bqp = BQP<std::int32_t>(large);
+    }(), Contains("Q has coefficients too large for its integer type"));
+    REQUIRE(BQP<std::int64_t>(large).getObjective(BitVector(vector<int> {1, 1})) == 2147483648.0);
+}
@@ -0,0 +1,93 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+#include "common.h"
+#include "elite_pool.h"
+
+using std::vector;
+
+namespace {
+
+BitVector solution(const vector<int> &values) {
+    return BitVector(values);
+}
+
+}
+
+TEST_CASE("Test ElitePool keeps the best solutions sorted") {
+    ElitePool pool(2);
+    REQUIRE(pool.offer(solution({0, 0, 0}), 3));
+    REQUIRE(pool.offer(solution({1, 0, 0}), 1));
+    REQUIRE(pool.size() == 2);
+    CHECK(pool.energy(0) == 1);
+    CHECK(pool.energy(1) == 3);
+
+    // The worst elite makes way for a better solution, not for a worse one
+    CHECK(pool.offer(solution({0, 1, 0}), 2));
+    CHECK_FALSE(pool.offer(solution({0, 0, 1}), 5));
+    REQUIRE(pool.size() == 2);
+    CHECK(pool.solution(0) == solution({1, 0, 0}));
+    CHECK(pool.solution(1) == solution({0, 1, 0}));
+
+    // Solutions already in the pool are not added twice
+    CHECK_FALSE(pool.offer(solution({1, 0, 0}), 1));
+    CHECK(pool.size() == 2);
+
+    ElitePool none;
+    CHECK_FALSE(none.offer(solution({0, 0, 0}), 0));
+    CHECK(none.size() == 0);
+
+    CHECK_THROWS_AS(ElitePool(-1), Exception);
+    CHECK_THROWS_AS(ElitePool(1, 0), Exception);
+}
+
+TEST_CASE("Test ElitePool keeps elites apart") {
+    ElitePool pool(4, 3);
+    REQUIRE(pool.offer(solution({0, 0, 0, 0}), 0));
+    REQUIRE(pool.offer(solution({1, 1, 1, 1}), 1));
+
+    // Within distance 3 of an elite: rejected unless better, then replacing it
+    CHECK_FALSE(pool.offer(solution({1, 0, 0, 0}), 0.5));
+    CHECK(pool.offer(solution({1, 1, 1, 0}), 0.5));
+    REQUIRE(pool.size() == 2);
+    CHECK(pool.solution(1) == solution({1, 1, 1, 0}));
+
+    // A solution close to several elites replaces all of them
+    CHECK(pool.offer(solution({1, 1, 0, 0}), -1));
+    REQUIRE(pool.size() == 1);
+    CHECK(pool.energy(0) == -1);
+
+    std::default_random_engine generator(2022);
+    ElitePool random(5, 3);
+    for (int t = 0; t < 500; t++) {
+        vector<int> values(10);
+        for (int &v : values) {
+            v = generator() % 2;
+        }
+        random.offer(BitVector(values), generator() % 100);
+    }
+    REQUIRE(random.size() == 5);
+    for (int a = 0; a < random.size(); a++) {
+        for (int b = a + 1; b < random.size(); b++) {
+            CHECK(random.energy(a) <= random.energy(b));
+            CHECK(random.solution(a).distance(random.solution(b)) >= 3);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kernels.h"
+
+using std::vector;
+
+TEMPLATE_TEST_CASE("Test kernels against reference loops", "", double, float, std::int32_t, std::int64_t) {
+    std::string isa = kernelInstructionSet();
+    INFO("instruction set " << isa);
+    REQUIRE((isa == "avx512" || isa == "avx2" || isa == "scalar"));
+
+    std::default_random_engine generator(2022);
+    std::uniform_int_distribution<int> coeff(-3, 3);
+    std::uniform_int_distribution<int> bit(0, 1);
+
+    // Lengths around the vector widths exercise the scalar tails
+    for (int n = 0; n < 37; n++) {
+        vector<TestType> q(n), sign(n), delta(n);
+        vector<long long> tabooUntil(n);
+        for (int j = 0; j < n; j++) {
+            q[j] = coeff(generator);
+            sign[j] = 1 - 2 * bit(generator);
+            delta[j] = coeff(generator);
+            tabooUntil[j] = 4 + coeff(generator);
+        }
+
+        vector<TestType> expected(delta);
+        for (int j = 0; j < n; j++) {
+            expected[j] += (sign[j] == 1)? q[j] : -q[j];
+        }
+        addSignedRow(n, q.data(), sign.data(), (TestType)1, delta.data());
+        REQUIRE(delta == expected);
+
+        long long now = 5;
+        for (double threshold : {-100.0, 8.0, 10.0}) {
+            double base = 10;
+            int expectedK = -1;
+            long long expectedEvaluated = 0;
+            double expectedMin = std::numeric_limits<double>::max();
+            for (int j = 0; j < n; j++) {
+                if (tabooUntil[j] >= now) {
+                    continue;
+                }
+                expectedEvaluated++;
+                if (base + delta[j] < threshold) {
+                    expectedK = j;
+                    break;
+                }
+                expectedMin = std::min(expectedMin, base + delta[j]);
+            }
+
+            double minCost;
+            long long numEvaluated = 5;
+            int k = scanMoves(n, delta.data(), tabooUntil.data(), now, base, threshold, minCost, numEvaluated);
+            REQUIRE(k == expectedK);
+            REQUIRE(numEvaluated == 5 + expectedEvaluated);
+            if (k == -1) {
+                REQUIRE(minCost == expectedMin);
+
+                vector<int> expectedTies;
+                for (int j = 0; j < n; j++) {
+                    if (tabooUntil[j] < now && base + delta[j] == minCost) {
+                        expectedTies.push_back(j);
+                    }
+                }
+                vector<int> ties(n);
+                ties.resize(collectTies(n, delta.data(), tabooUntil.data(), now, base, minCost, ties.data()));
+                REQUIRE(ties == expectedTies);
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "move_tree.h"
+
+using std::vector;
+
+TEST_CASE("Test MoveTree against a linear scan") {
+    std::default_random_engine generator(2022);
+    std::uniform_int_distribution<int> value(-3, 3);
+
+    for (int n : {1, 2, 5, 8, 13}) {
+        vector<double> values(n);
+        vector<bool> taboo(n, false);
+        for (int i = 0; i < n; i++) {
+            values[i] = value(generator);
+        }
+        MoveTree tree(values);
+
+        for (int op = 0; op < 200; op++) {
+            int i = generator() % n;
+            switch (generator() % 3) {
+                case 0:
+                    values[i] = value(generator);
+                    tree.update(i, values[i]);
+                    break;
+                case 1:
+                    taboo[i] = true;
+                    tree.setTaboo(i);
+                    break;
+                default:
+                    taboo[i] = false;
+                    tree.clearTaboo(i, values[i]);
+            }
+
+            vector<int> ties;
+            double minValue = std::numeric_limits<double>::infinity();
+            for (int j = 0; j < n; j++) {
+                if (taboo[j]) {
+                    continue;
+                }
+                if (values[j] < minValue) {
+                    minValue = values[j];
+                    ties.clear();
+                }
+                if (values[j] == minValue) {
+                    ties.push_back(j);
+                }
+            }
+            REQUIRE(tree.minValue() == minValue);
+            REQUIRE(tree.minCount() == (int)ties.size());
+            for (int r = 0; r < (int)ties.size(); r++) {
+                REQUIRE(tree.findMin(r) == ties[r]);
+            }
+
+            int allowed = 0;
+            int firstBelow = -1;
+            for (int j = 0; j < n; j++) {
+                REQUIRE(tree.countAllowed(j) == allowed);
+                if (!taboo[j]) {
+                    allowed++;
+                    if (firstBelow == -1 && 10 + values[j] < 9) {
+                        firstBelow = j;
+                    }
+                }
+            }
+            REQUIRE(tree.countAllowed(n) == allowed);
+            REQUIRE(tree.firstBelow(10, 9) == firstBelow);
+        }
+
+        // Reset allows every move again
+        tree.reset(values);
+        REQUIRE(tree.countAllowed(n) == n);
+    }
+}
@@ -0,0 +1,69 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include "phase_timer.h"
+
+namespace {
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+}
+
+TEST_CASE("Test PhaseTimer") {
+    PhaseTimes times;
+    {
+        PhaseTimer outer(times, PHASE_TABU_LOOP);
+        sleepMs(20);
+        for (int i = 0; i < 3; i++) {
+            PhaseTimer inner(times, PHASE_LOCAL_SEARCH);
+            sleepMs(10);
+        }
+        PhaseTimer stopped(times, PHASE_INITIALIZE);
+        stopped.stop();
+        sleepMs(20);
+    }
+
+    if (!phaseTimingEnabled()) {
+        // Compiled out
+        for (int p = 0; p < NUM_PHASES; p++) {
+            REQUIRE(times.count(p) == 0);
+            REQUIRE(times.seconds(p) == 0);
+        }
+        return;
+    }
+
+    REQUIRE(times.count(PHASE_TABU_LOOP) == 1);
+    REQUIRE(times.count(PHASE_LOCAL_SEARCH) == 3);
+    REQUIRE(times.count(PHASE_INITIALIZE) == 1);
+    REQUIRE(times.count(PHASE_CONSTRUCT) == 0);
+
+    // The outer phase excludes the inner one, and a stopped timer adds nothing more
+    REQUIRE(times.seconds(PHASE_LOCAL_SEARCH) > 0.025);
+    REQUIRE(times.seconds(PHASE_TABU_LOOP) > 0.035);
+    REQUIRE(times.seconds(PHASE_TABU_LOOP) < 0.065);
+    REQUIRE(times.seconds(PHASE_INITIALIZE) < 0.005);
+
+    PhaseTimes sum;
+    sum.add(times);
+    sum.add(times);
+    REQUIRE(sum.count(PHASE_LOCAL_SEARCH) == 6);
+    REQUIRE(sum.ticks[PHASE_TABU_LOOP] == 2 * times.ticks[PHASE_TABU_LOOP]);
+}
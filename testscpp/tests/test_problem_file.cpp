@@ -0,0 +1,138 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bqp.h"
+#include "problem_file.h"
+
+using std::vector;
+using Catch::Matchers::Contains;
+
+namespace {
+
+const char *PATH = "test_problem_file.tabubqp";
+
+// Random problem with about density percent of the couplings present
+template <class T>
+BQP<T> randomProblem(int n, int density, std::default_random_engine &generator) {
+    vector<T> linear(n), values;
+    vector<int> irow, icol;
+    for (int i = 0; i < n; i++) {
+        linear[i] = (T)(generator() % 21) - 10;
+        for (int j = i + 1; j < n; j++) {
+            if ((int)(generator() % 100) < density) {
+                irow.push_back(i);
+                icol.push_back(j);
+                values.push_back((T)(generator() % 21) - 10);
+            }
+        }
+    }
+    return BQP<T>(n, linear.data(), values.size(), irow.data(), icol.data(), values.data());
+}
+
+}
+
+TEMPLATE_TEST_CASE("Test problem file round trip", "", double, std::int32_t) {
+    std::default_random_engine generator(3);
+    for (int density : {5, 80}) {
+        int n = 70;
+        BQP<TestType> original = randomProblem<TestType>(n, density, generator);
+        writeProblemFile(PATH, original, "labels");
+
+        auto file = std::make_shared<const ProblemFile>(PATH);
+        REQUIRE(file->numVariables() == n);
+        REQUIRE(file->coefficientType() == coefficientTypeOf<TestType>());
+        REQUIRE(file->labels() == "labels");
+
+        BQP<TestType> mapped(file);
+        REQUIRE(mapped.dense == original.dense);
+
+        // Sparse problems are read in the mapping, dense ones are copied
+        if (!mapped.dense) {
+            REQUIRE((const void *)mapped.linearView == (const void *)file->linear<TestType>());
+            REQUIRE(mapped.couplingsView == file->couplings<TestType>());
+        }
+
+        for (int k = 0; k < 20; k++) {
+            BitVector solution(n);
+            for (int i = 0; i < n; i++) {
+                solution.set(i, generator() & 1);
+            }
+            REQUIRE(mapped.getObjective(solution) == original.getObjective(solution));
+            for (int i = 0; i < n; i++) {
+                REQUIRE(mapped.getChangeInObjective(solution, i) == original.getChangeInObjective(solution, i));
+            }
+        }
+        REQUIRE(mapped.getMaxBQPCoeff() == original.getMaxBQPCoeff());
+    }
+    std::remove(PATH);
+}
+
+TEST_CASE("Test problem file errors") {
+    std::default_random_engine generator(5);
+    BQP<double> original = randomProblem<double>(10, 20, generator);
+
+    SECTION("Missing file") {
+        REQUIRE_THROWS_WITH(ProblemFile("no/such/file"), Contains("cannot open problem file"));
+    }
+
+    SECTION("Coefficient type") {
+        writeProblemFile(PATH, original, "");
+        auto file = std::make_shared<const ProblemFile>(PATH);
+        REQUIRE(file->labels().empty());
+        REQUIRE_THROWS_WITH(BQP<float>(file), "problem file has a different coefficient type");
+    }
+
+    SECTION("Not a problem file") {
+        FILE *file = fopen(PATH, "wb");
+        vector<char> zeros(256, 0);
+        fwrite(zeros.data(), 1, zeros.size(), file);
+        fclose(file);
+        REQUIRE_THROWS_WITH(ProblemFile(PATH), Contains("not a valid problem file"));
+    }
+
+    SECTION("Truncated file") {
+        writeProblemFile(PATH, original, "");
+        FILE *file = fopen(PATH, "rb");
+        vector<char> bytes(4096);
+        bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+        fclose(file);
+        file = fopen(PATH, "wb");
+        fwrite(bytes.data(), 1, bytes.size() - 16, file);
+        fclose(file);
+        REQUIRE_THROWS_WITH(ProblemFile(PATH), Contains("not a valid problem file"));
+    }
+
+    SECTION("Index out of range") {
+        writeProblemFile(PATH, original, "");
+        ProblemFileHeader header;
+        FILE *file = fopen(PATH, "r+b");
+        REQUIRE(fread(&header, sizeof(header), 1, file) == 1);
+        int bad = 10;
+        fseek(file, header.neighborsOffset, SEEK_SET);
+        fwrite(&bad, sizeof(bad), 1, file);
+        fclose(file);
+        REQUIRE_THROWS_WITH(BQP<double>(std::make_shared<const ProblemFile>(PATH)),
+                            "couplings must join two distinct variables in range");
+    }
+    std::remove(PATH);
+}
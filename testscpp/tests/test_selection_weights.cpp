@@ -0,0 +1,113 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "selection_weights.h"
+
+using std::vector;
+
+// Reference weights of the unselected variables, as in the linear selection loop
+vector<double> referenceWeights(const vector<double> &d, const vector<bool> &selected, double lambda) {
+    double dmin = 1e300, dmax = -1e300;
+    for (size_t i = 0; i < d.size(); i++) {
+        if (!selected[i]) {
+            dmin = std::min(dmin, d[i]);
+            dmax = std::max(dmax, d[i]);
+        }
+    }
+    vector<double> e(d.size(), 0);
+    for (size_t i = 0; i < d.size(); i++) {
+        if (selected[i]) {
+            continue;
+        }
+        if (dmin == dmax) {
+            e[i] = 1;
+        }
+        else if (d[i] <= 0 && dmin < 0) {
+            e[i] = 1 - d[i] / dmin;
+        }
+        else if (d[i] == dmin && dmin == 0) {
+            e[i] = 0;
+        }
+        else {
+            e[i] = 1 + lambda * (d[i] / dmax);
+        }
+    }
+    return e;
+}
+
+TEST_CASE("Test SelectionWeights against the reference weights") {
+    std::default_random_engine generator(2022);
+    std::uniform_int_distribution<int> value(-4, 4);
+
+    for (int n : {1, 2, 7, 16, 33}) {
+        vector<double> d(n);
+        for (int i = 0; i < n; i++) {
+            d[i] = value(generator);
+        }
+        vector<bool> selected(n, false);
+        SelectionWeights weights(d, 50);
+
+        for (int ctr = 0; ctr < n; ctr++) {
+            vector<double> e = referenceWeights(d, selected, 50);
+            double sum = 0;
+            for (double w : e) {
+                sum += w;
+            }
+
+            // Draws at the middle of every interval of the cumulative weights
+            // pick the variable owning it, and u = 0 the first unselected one
+            int first = -1;
+            double prefix = 0;
+            for (int i = 0; i < n; i++) {
+                if (first == -1 && !selected[i]) {
+                    first = i;
+                }
+                if (e[i] > 0) {
+                    REQUIRE(weights.sample((prefix + e[i] / 2) / sum) == i);
+                }
+                prefix += e[i];
+            }
+            REQUIRE(weights.sample(0) == first);
+
+            // Select a variable and change the estimates of a few others
+            int s = weights.sample(std::uniform_real_distribution<double>(0, 1)(generator));
+            REQUIRE(s >= 0);
+            REQUIRE_FALSE(selected[s]);
+            selected[s] = true;
+            weights.remove(s);
+            for (int i = 0; i < n; i++) {
+                if (!selected[i] && generator() % 3 == 0) {
+                    double delta = value(generator);
+                    d[i] += delta;
+                    weights.add(i, delta);
+                }
+            }
+        }
+        REQUIRE(weights.sample(0.5) == -1);
+    }
+}
+
+TEST_CASE("Test SelectionWeights with all weights zero but one") {
+    // d == dmin == 0 has weight zero, so only the positive estimate is drawn
+    SelectionWeights weights({0, 0, 3, 0}, 10);
+    for (double u : {0.01, 0.5, 0.99}) {
+        REQUIRE(weights.sample(u) == 2);
+    }
+}
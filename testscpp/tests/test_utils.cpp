@@ -0,0 +1,84 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "utils.h"
+
+using std::vector;
+using Catch::Matchers::Contains;
+
+TEST_CASE("Test parallel_for()") {
+    for (int numThreads : {0, 1, 3, 16}) {
+        vector<int> calls(10, 0);
+        parallel_for(calls.size(), numThreads, [&](int i) { calls[i]++; });
+
+        // Every task runs exactly once
+        REQUIRE(calls == vector<int>(10, 1));
+    }
+
+    REQUIRE_THROWS_WITH(parallel_for(100, 4, [](int i) {
+        if (i == 0) {
+            throw Exception("task failed");
+        }
+    }), Contains("task failed"));
+
+    parallel_for(0, 4, [](int) { FAIL("no tasks to run"); });
+}
+
+TEST_CASE("Test Deadline") {
+    // The clock is read on the first call
+    REQUIRE(Deadline(realtime_clock() - 1).passed());
+
+    Deadline later(realtime_clock() + 100000);
+    for (int i = 0; i < 100000; i++) {
+        REQUIRE_FALSE(later.passed());
+    }
+
+    // Checks get sparser in a tight loop, yet a deadline is not overshot by much
+    long long start = realtime_clock();
+    Deadline soon(start + 20);
+    while (!soon.passed()) {}
+    long long elapsed = realtime_clock() - start;
+    REQUIRE(elapsed > 20);
+    REQUIRE(elapsed < 100);
+}
+
+TEST_CASE("Test Deadline after slow steps") {
+    // A stride adapted to a tight loop is restarted by checkNext(), so steps
+    // much slower than the loop overshoot the deadline by about one step
+    long long start = realtime_clock();
+    Deadline deadline(start + 40);
+    bool early = false;
+    while (realtime_clock() < start + 20) {
+        early = deadline.passed() || early;
+    }
+    REQUIRE_FALSE(early);
+
+    bool passed = false;
+    for (int step = 0; step < 100 && !passed; step++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        deadline.checkNext();
+        passed = deadline.passed();
+    }
+    long long elapsed = realtime_clock() - start;
+    REQUIRE(passed);
+    REQUIRE(elapsed > 40);
+    REQUIRE(elapsed < 60);
+}
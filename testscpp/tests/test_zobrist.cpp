@@ -0,0 +1,79 @@
+// Copyright 2022 D-Wave Systems Inc.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+
+#include "../Catch2/single_include/catch2/catch.hpp"
+
+#include <random>
+#include <set>
+
+#include "common.h"
+#include "zobrist.h"
+
+TEST_CASE("Test ZobristKeys hash flips incrementally") {
+    int n = 130;
+    ZobristKeys keys(n);
+    REQUIRE(keys.size() == n);
+
+    std::set<std::uint64_t> distinct;
+    for (int i = 0; i < n; i++) {
+        distinct.insert(keys.key(i));
+    }
+    CHECK(distinct.size() == (size_t)n);
+
+    BitVector solution(n);
+    CHECK(keys.hash(solution) == 0);
+
+    // XORing the key of every flipped variable gives the hash from scratch
+    std::mt19937 generator(1);
+    std::uint64_t hash = 0;
+    for (int k = 0; k < 1000; k++) {
+        int i = generator() % n;
+        solution.flip(i);
+        hash ^= keys.key(i);
+        REQUIRE(hash == keys.hash(solution));
+    }
+
+    // Keys depend only on the variable
+    CHECK(ZobristKeys(n + 10).key(n - 1) == keys.key(n - 1));
+    CHECK(ZobristKeys().size() == 0);
+}
+
+TEST_CASE("Test VisitedSet reports hashes inserted before") {
+    VisitedSet visited(5);
+    REQUIRE(visited.capacity() == 8);
+
+    CHECK_FALSE(visited.insert(3));
+    CHECK_FALSE(visited.insert(4));
+    CHECK(visited.insert(3));
+    CHECK(visited.insert(4));
+
+    // A hash takes the slot of the one before it
+    CHECK_FALSE(visited.insert(3 + 8));
+    CHECK_FALSE(visited.insert(3));
+    CHECK(visited.insert(4));
+
+    // 0 is never stored, nor anything in an empty set
+    CHECK_FALSE(visited.insert(0));
+    CHECK_FALSE(visited.insert(0));
+    VisitedSet none;
+    CHECK(none.capacity() == 0);
+    CHECK_FALSE(none.insert(3));
+    CHECK_FALSE(none.insert(3));
+
+    CHECK(VisitedSet(1).capacity() == 1);
+    CHECK_THROWS_AS(VisitedSet(-1), Exception);
+    CHECK_THROWS_AS(VisitedSet((1 << 30) + 1), Exception);
+}